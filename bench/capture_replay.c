@@ -0,0 +1,275 @@
+/*
+ * capture_replay.c - feed a CAT capture through the receive path
+ *
+ * Walks a capture written by serial-send -w (radios/cat_capture.h) straight
+ * from its mapping and pushes every RX chunk through a framer per port, the
+ * opcode dispatcher and radio_state, with the recorded receive times.
+ * By default it goes as fast as possible and reports the throughput of the
+ * receive path; -r replays at the recorded speed instead, -v prints the
+ * session as it goes (TX included), which is what field problems need.
+ *
+ * -g writes a synthetic capture of mixed AI1 traffic, cut into chunks of
+ * 1 to 64 bytes like a USB-serial bridge delivers them, for benchmarking
+ * without a recorded session.
+ *
+ * Build and run:  make bench-replay
+ * Options:        capture_replay [-r] [-v] [-n <loops>] <capture>
+ *                 capture_replay -g <frames> <capture>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include "radios/ftx1_cat.h"
+#include "radios/cat_framer.h"
+#include "radios/cat_capture.h"
+#include "radios/radio_state.h"
+
+#define MAX_PORTS 4
+
+typedef struct {
+    cat_framer_t framer[MAX_PORTS];
+    radio_state_t state[MAX_PORTS];
+    uint64_t first_ns;
+    int verbose;
+    int port;                   /* Port of the chunk being pushed */
+    /* Totals */
+    uint64_t rx_records, tx_records, rx_bytes, tx_bytes;
+    uint64_t frames, decoded;
+} replay_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void on_frames(const cat_frame_t *frames, size_t count, void *user_data)
+{
+    replay_t *rp = user_data;
+    radio_state_t *state = &rp->state[rp->port];
+
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t changed = radio_state_feed(state, frames[i].data, frames[i].len);
+        bool known = cat_get_response_length(frames[i].data) >= 0 && frames[i].data[0] != '?';
+        rp->decoded += known;
+
+        if (rp->verbose)
+            printf("%12.3f ms  RX%d  frame %.*s%s\n", (frames[i].rx_ns - rp->first_ns) / 1e6, rp->port,
+                   (int)frames[i].len, frames[i].data,
+                   !known ? "  (unknown)" : changed ? "  (changed)" : "");
+    }
+    rp->frames += count;
+}
+
+/* Print a chunk with its control bytes visible */
+static void print_chunk(const replay_t *rp, const cat_capture_record_t *rec, const char *data)
+{
+    printf("%12.3f ms  %s%u  %4u B  \"", (rec->t_ns - rp->first_ns) / 1e6,
+           rec->dir == CAT_CAPTURE_TX ? "TX" : "RX", rec->port, rec->len);
+    for (uint32_t i = 0; i < rec->len; ++i) {
+        unsigned char c = (unsigned char)data[i];
+        if (c == '\n')
+            fputs("\\n", stdout);
+        else if (c == '\r')
+            fputs("\\r", stdout);
+        else if (c < 0x20 || c >= 0x7f)
+            printf("\\x%02x", c);
+        else
+            putchar(c);
+    }
+    puts("\"");
+}
+
+static void sleep_until(uint64_t t_ns)
+{
+    struct timespec ts = { .tv_sec = (time_t)(t_ns / 1000000000ull), .tv_nsec = (long)(t_ns % 1000000000ull) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+/* One pass over the capture. -1 if a record is corrupt. */
+static int replay_pass(replay_t *rp, cat_capture_reader_t *reader, int realtime, uint64_t start_ns)
+{
+    cat_capture_record_t rec;
+    const char *data;
+    int rc;
+
+    cat_capture_rewind(reader);
+    while ((rc = cat_capture_next(reader, &rec, &data)) == 1) {
+        if (!rp->first_ns)
+            rp->first_ns = rec.t_ns;
+        if (realtime)
+            sleep_until(start_ns + (rec.t_ns - rp->first_ns));
+        if (rp->verbose)
+            print_chunk(rp, &rec, data);
+
+        if (rec.dir == CAT_CAPTURE_TX) {
+            rp->tx_records++;
+            rp->tx_bytes += rec.len;
+            continue;
+        }
+        rp->rx_records++;
+        rp->rx_bytes += rec.len;
+        rp->port = rec.port < MAX_PORTS ? rec.port : MAX_PORTS - 1;
+        cat_framer_push_at(&rp->framer[rp->port], data, rec.len, rec.t_ns, on_frames, rp);
+    }
+    return rc;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Synthetic capture */
+
+static const char *const traffic[] = {
+    "FA014074000;", "FB007074000;", "MD02;", "MD11;", "AG0128;", "RG0255;",
+    "SQ0010;", "PC100;", "GT00;", "ST0;", "CN00012;", "FA014074010;",
+};
+#define TRAFFIC_COUNT (sizeof(traffic)/sizeof(traffic[0]))
+
+/* Record a block of the stream as reads of 1-64 bytes, a millisecond apart */
+static int write_chunks(cat_capture_t *cap, const char *stream, size_t used, uint64_t *t, unsigned *seed)
+{
+    for (size_t off = 0; off < used; ) {
+        *seed = *seed * 1103515245u + 12345u;
+        size_t chunk = 1 + (*seed >> 16) % 64;
+        if (chunk > used - off)
+            chunk = used - off;
+        if (cat_capture_write(cap, CAT_CAPTURE_RX, 0, *t, stream + off, chunk) < 0)
+            return -1;
+        off += chunk;
+        *t += 1000000;
+    }
+    return 0;
+}
+
+static int generate(const char *path, long frames)
+{
+    cat_capture_t cap;
+    if (unlink(path) < 0 && errno != ENOENT) {
+        perror(path);
+        return -1;
+    }
+    if (cat_capture_open(&cap, path) < 0) {
+        perror(path);
+        return -1;
+    }
+
+    static char stream[64 * 1024];
+    size_t used = 0;
+    uint64_t t = 1000000000ull;
+    unsigned seed = 1;
+    int rc = 0;
+    for (long f = 0; f < frames && rc == 0; ++f) {
+        const char *frame = traffic[f % TRAFFIC_COUNT];
+        size_t len = strlen(frame);
+        if (used + len > sizeof(stream)) {
+            rc = write_chunks(&cap, stream, used, &t, &seed);
+            used = 0;
+        }
+        memcpy(stream + used, frame, len);
+        used += len;
+    }
+    if (rc == 0)
+        rc = write_chunks(&cap, stream, used, &t, &seed);
+    if (rc < 0)
+        perror(path);
+    cat_capture_close(&cap);
+    return rc;
+}
+
+/* -------------------------------------------------------------------------- */
+static void print_usage(const char *progname)
+{
+    printf("Usage: %s [-r] [-v] [-n loops] <capture>\n"
+           "       %s -g <frames> <capture>\n"
+           "  -r          Replay at the recorded speed (default: as fast as possible)\n"
+           "  -v          Print every chunk and frame with its time\n"
+           "  -n <loops>  Passes over the capture, for benchmarking (default 1)\n"
+           "  -g <frames> Write a synthetic capture of that many AI1 frames\n",
+           progname, progname);
+}
+
+static long parse_positive(const char *arg, const char *what)
+{
+    char *endptr = NULL;
+    long v = strtol(arg, &endptr, 10);
+    if (*endptr != '\0' || v <= 0) {
+        fprintf(stderr, "Invalid %s \"%s\"\n", what, arg);
+        exit(EXIT_FAILURE);
+    }
+    return v;
+}
+
+int main(int argc, char *argv[])
+{
+    int realtime = 0, verbose = 0;
+    long loops = 1, generate_frames = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "rvn:g:h")) != -1) {
+        switch (opt) {
+            case 'r': realtime = 1; break;
+            case 'v': verbose = 1; break;
+            case 'n': loops = parse_positive(optarg, "loop count"); break;
+            case 'g': generate_frames = parse_positive(optarg, "frame count"); break;
+            case 'h':
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *path = argv[optind];
+
+    if (generate_frames)
+        return generate(path, generate_frames) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    cat_capture_reader_t reader;
+    if (cat_capture_map(&reader, path) < 0) {
+        fprintf(stderr, "%s: %s\n", path, errno == EINVAL ? "not a capture" : strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    static replay_t rp;
+    rp.verbose = verbose;
+    for (int p = 0; p < MAX_PORTS; ++p) {
+        cat_framer_reset(&rp.framer[p]);
+        radio_state_reset(&rp.state[p]);
+    }
+
+    int status = EXIT_SUCCESS;
+    uint64_t begin = now_ns();
+    for (long l = 0; l < loops; ++l) {
+        if (replay_pass(&rp, &reader, realtime, now_ns()) < 0) {
+            fprintf(stderr, "%s: corrupt record at offset %zu\n", path, reader.offset);
+            status = EXIT_FAILURE;
+            break;
+        }
+        rp.first_ns = 0;
+    }
+    double seconds = (now_ns() - begin) / 1e9;
+
+    printf("%llu RX chunk(s), %llu byte(s); %llu TX chunk(s), %llu byte(s)%s\n",
+           (unsigned long long)rp.rx_records, (unsigned long long)rp.rx_bytes,
+           (unsigned long long)rp.tx_records, (unsigned long long)rp.tx_bytes,
+           reader.truncated ? "; last record incomplete" : "");
+    printf("%llu frame(s), %llu decoded, %llu byte(s) dropped by the framer\n",
+           (unsigned long long)rp.frames, (unsigned long long)rp.decoded,
+           (unsigned long long)rp.framer[0].dropped + rp.framer[1].dropped +
+           rp.framer[2].dropped + rp.framer[3].dropped);
+    if (!realtime && !verbose && seconds > 0)
+        printf("%.3f s: %.3f GB/s, %.1f Mframes/s through framer + parser + state\n",
+               seconds, rp.rx_bytes / seconds / 1e9, rp.frames / seconds / 1e6);
+
+    cat_capture_unmap(&reader);
+    return status;
+}
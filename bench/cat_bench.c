@@ -0,0 +1,321 @@
+/*
+ * cat_bench.c - micro-benchmark for the FTX-1 CAT codec
+ *
+ * Runs every cat_build_* builder, the wire encoder, every cat_parse_*
+ * parser and the framer + dispatcher over a stream of mixed AI1 traffic.
+ * Reports ns/op, frames (ops) per second and heap allocations per op.
+ *
+ * Build and run:  make bench
+ * Options:        -n <iterations>  -c (CSV output for comparing runs)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "radios/ftx1_cat.h"
+#include "radios/cat_framer.h"
+
+#define DEFAULT_ITERATIONS 2000000
+
+/* -------------------------------------------------------------------------- */
+/* Allocation counting: the Makefile links with -Wl,--wrap=malloc,... */
+static unsigned long alloc_count;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) { alloc_count++; return __real_malloc(size); }
+void *__wrap_calloc(size_t nmemb, size_t size) { alloc_count++; return __real_calloc(nmemb, size); }
+void *__wrap_realloc(void *ptr, size_t size) { alloc_count++; return __real_realloc(ptr, size); }
+
+/* -------------------------------------------------------------------------- */
+static volatile unsigned long sink;   /* Keeps results observable */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int csv_output;
+
+static void report(const char *name, uint64_t elapsed_ns, unsigned long ops, unsigned long allocs)
+{
+    double ns_op = (double)elapsed_ns / (double)ops;
+    double per_s = ops * 1e9 / (double)elapsed_ns;
+    double allocs_op = (double)allocs / (double)ops;
+
+    if (csv_output)
+        printf("%s,%.2f,%.0f,%.3f\n", name, ns_op, per_s, allocs_op);
+    else
+        printf("  %-28s %9.2f ns/op %14.0f frames/s %8.3f allocs/op\n",
+               name, ns_op, per_s, allocs_op);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Builders */
+
+typedef int (*build_fn)(cat_command_t *cmd, unsigned long i);
+
+static int b_frequency_set(cat_command_t *c, unsigned long i) { return cat_build_frequency_set(c, VFO_MAIN, 14074000 + (uint32_t)(i & 0xFFF)); }
+static int b_frequency_read(cat_command_t *c, unsigned long i) { return cat_build_frequency_read(c, (vfo_select_t)(i & 1)); }
+static int b_mode_set(cat_command_t *c, unsigned long i) { return cat_build_mode_set(c, (vfo_select_t)(i & 1), MODE_DATA_USB); }
+static int b_mode_read(cat_command_t *c, unsigned long i) { return cat_build_mode_read(c, (vfo_select_t)(i & 1)); }
+static int b_af_gain_set(cat_command_t *c, unsigned long i) { return cat_build_af_gain_set(c, VFO_MAIN, (uint8_t)i); }
+static int b_af_gain_read(cat_command_t *c, unsigned long i) { return cat_build_af_gain_read(c, (vfo_select_t)(i & 1)); }
+static int b_rf_gain_set(cat_command_t *c, unsigned long i) { return cat_build_rf_gain_set(c, VFO_MAIN, (uint8_t)i); }
+static int b_rf_gain_read(cat_command_t *c, unsigned long i) { return cat_build_rf_gain_read(c, (vfo_select_t)(i & 1)); }
+static int b_squelch_set(cat_command_t *c, unsigned long i) { return cat_build_squelch_set(c, VFO_MAIN, (uint8_t)i); }
+static int b_squelch_read(cat_command_t *c, unsigned long i) { return cat_build_squelch_read(c, (vfo_select_t)(i & 1)); }
+static int b_power_set(cat_command_t *c, unsigned long i) { return cat_build_power_set(c, (uint8_t)(5 + i % 96)); }
+static int b_power_read(cat_command_t *c, unsigned long i) { (void)i; return cat_build_power_read(c); }
+static int b_agc_set(cat_command_t *c, unsigned long i) { return cat_build_agc_set(c, VFO_MAIN, (agc_type_t)(i % 5)); }
+static int b_agc_read(cat_command_t *c, unsigned long i) { return cat_build_agc_read(c, (vfo_select_t)(i & 1)); }
+static int b_band_up(cat_command_t *c, unsigned long i) { return cat_build_band_up(c, (vfo_select_t)(i & 1)); }
+static int b_band_down(cat_command_t *c, unsigned long i) { return cat_build_band_down(c, (vfo_select_t)(i & 1)); }
+static int b_band_select(cat_command_t *c, unsigned long i) { return cat_build_band_select(c, VFO_MAIN, (band_select_t)(i % 15)); }
+static int b_vfo_ab(cat_command_t *c, unsigned long i) { (void)i; return cat_build_vfo_ab(c); }
+static int b_vfo_ba(cat_command_t *c, unsigned long i) { (void)i; return cat_build_vfo_ba(c); }
+static int b_split_set(cat_command_t *c, unsigned long i) { return cat_build_split_set(c, i & 1); }
+static int b_split_read(cat_command_t *c, unsigned long i) { (void)i; return cat_build_split_read(c); }
+static int b_ctcss_set(cat_command_t *c, unsigned long i) { return cat_build_ctcss_set(c, VFO_MAIN, 0, (uint8_t)(i % 50)); }
+static int b_ctcss_read(cat_command_t *c, unsigned long i) { return cat_build_ctcss_read(c, (vfo_select_t)(i & 1)); }
+static int b_auto_info_set(cat_command_t *c, unsigned long i) { return cat_build_auto_info_set(c, i & 1); }
+static int b_firmware_version_read(cat_command_t *c, unsigned long i) { (void)i; return cat_build_firmware_version_read(c); }
+static int b_radio_info_read(cat_command_t *c, unsigned long i) { (void)i; return cat_build_radio_info_read(c); }
+
+static const struct {
+    const char *name;
+    build_fn fn;
+} builders[] = {
+    { "build_frequency_set",         b_frequency_set         },
+    { "build_frequency_read",        b_frequency_read        },
+    { "build_mode_set",              b_mode_set              },
+    { "build_mode_read",             b_mode_read             },
+    { "build_af_gain_set",           b_af_gain_set           },
+    { "build_af_gain_read",          b_af_gain_read          },
+    { "build_rf_gain_set",           b_rf_gain_set           },
+    { "build_rf_gain_read",          b_rf_gain_read          },
+    { "build_squelch_set",           b_squelch_set           },
+    { "build_squelch_read",          b_squelch_read          },
+    { "build_power_set",             b_power_set             },
+    { "build_power_read",            b_power_read            },
+    { "build_agc_set",               b_agc_set               },
+    { "build_agc_read",              b_agc_read              },
+    { "build_band_up",               b_band_up               },
+    { "build_band_down",             b_band_down             },
+    { "build_band_select",           b_band_select           },
+    { "build_vfo_ab",                b_vfo_ab                },
+    { "build_vfo_ba",                b_vfo_ba                },
+    { "build_split_set",             b_split_set             },
+    { "build_split_read",            b_split_read            },
+    { "build_ctcss_set",             b_ctcss_set             },
+    { "build_ctcss_read",            b_ctcss_read            },
+    { "build_auto_info_set",         b_auto_info_set         },
+    { "build_firmware_version_read", b_firmware_version_read },
+    { "build_radio_info_read",       b_radio_info_read       },
+};
+#define BUILDER_COUNT (sizeof(builders)/sizeof(builders[0]))
+
+static void bench_builders(unsigned long iterations)
+{
+    cat_command_t cmd;
+
+    for (size_t b = 0; b < BUILDER_COUNT; ++b) {
+        unsigned long allocs = alloc_count;
+        uint64_t start = now_ns();
+        for (unsigned long i = 0; i < iterations; ++i) {
+            builders[b].fn(&cmd, i);
+            sink += (unsigned char)cmd.params[0];
+        }
+        report(builders[b].name, now_ns() - start, iterations, alloc_count - allocs);
+    }
+}
+
+static void bench_encoder(unsigned long iterations)
+{
+    cat_command_t cmds[16];
+    char wire[16 * CAT_WIRE_MAX];
+
+    for (size_t i = 0; i < 16; ++i)
+        builders[i % BUILDER_COUNT].fn(&cmds[i], i);
+
+    unsigned long allocs = alloc_count;
+    uint64_t start = now_ns();
+    for (unsigned long i = 0; i < iterations; ++i) {
+        cat_build_frequency_set(&cmds[0], VFO_MAIN, 14074000 + (uint32_t)(i & 0xFFF));
+        sink += (unsigned long)cat_encode_command(&cmds[0], wire, sizeof(wire));
+    }
+    report("tune_build_encode", now_ns() - start, iterations, alloc_count - allocs);
+
+    allocs = alloc_count;
+    start = now_ns();
+    for (unsigned long i = 0; i < iterations / 16; ++i)
+        sink += (unsigned long)cat_encode_batch(cmds, 16, wire, sizeof(wire));
+    report("encode_batch_per_cmd", now_ns() - start, (iterations / 16) * 16, alloc_count - allocs);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Parsers */
+
+typedef int (*parse_fn)(const char *response);
+
+static int p_frequency(const char *r) { frequency_info_t v; int rc = cat_parse_frequency_response(r, &v); sink += v.frequency; return rc; }
+static int p_mode(const char *r) { mode_info_t v; int rc = cat_parse_mode_response(r, &v); sink += v.mode; return rc; }
+static int p_af_gain(const char *r) { gain_info_t v; int rc = cat_parse_af_gain_response(r, &v); sink += v.level; return rc; }
+static int p_rf_gain(const char *r) { gain_info_t v; int rc = cat_parse_rf_gain_response(r, &v); sink += v.level; return rc; }
+static int p_squelch(const char *r) { squelch_info_t v; int rc = cat_parse_squelch_response(r, &v); sink += v.level; return rc; }
+static int p_power(const char *r) { power_info_t v; int rc = cat_parse_power_response(r, &v); sink += v.watts; return rc; }
+static int p_agc(const char *r) { agc_info_t v; int rc = cat_parse_agc_response(r, &v); sink += v.agc; return rc; }
+static int p_split(const char *r) { split_info_t v; int rc = cat_parse_split_response(r, &v); sink += v.enabled; return rc; }
+static int p_ctcss(const char *r) { ctcss_info_t v; int rc = cat_parse_ctcss_response(r, &v); sink += v.code; return rc; }
+static int p_firmware(const char *r) { firmware_info_t v; int rc = cat_parse_firmware_version_response(r, &v); sink += (unsigned char)v.version[0]; return rc; }
+static int p_radio_info(const char *r) { radio_info_t v; int rc = cat_parse_radio_info_response(r, &v); sink += (unsigned char)v.model[0]; return rc; }
+
+static const struct {
+    const char *name;
+    parse_fn fn;
+    const char *corpus[4];
+} parsers[] = {
+    { "parse_frequency",     p_frequency,  { "FA014074000;", "FB007074000;", "FA430100000;", "FA001840000;" } },
+    { "parse_mode",          p_mode,       { "MD02;", "MD1C;", "MD03;", "MD14;" } },
+    { "parse_af_gain",       p_af_gain,    { "AG0128;", "AG1255;", "AG0000;", "AG0064;" } },
+    { "parse_rf_gain",       p_rf_gain,    { "RG0255;", "RG1200;", "RG0100;", "RG0001;" } },
+    { "parse_squelch",       p_squelch,    { "SQ0000;", "SQ1050;", "SQ0100;", "SQ0025;" } },
+    { "parse_power",         p_power,      { "PC100;", "PC005;", "PC050;", "PC010;" } },
+    { "parse_agc",           p_agc,        { "GT00;", "GT11;", "GT02;", "GT13;" } },
+    { "parse_split",         p_split,      { "ST0;", "ST1;", "ST0;", "ST1;" } },
+    { "parse_ctcss",         p_ctcss,      { "CN00012;", "CN11023;", "CN00000;", "CN01049;" } },
+    { "parse_firmware",      p_firmware,   { "VE0108;", "VE0110;", "VE0108;", "VE0110;" } },
+    { "parse_radio_info",    p_radio_info, { "RI0000000;", "RI1000000;", "RI0000000;", "RI1000000;" } },
+};
+#define PARSER_COUNT (sizeof(parsers)/sizeof(parsers[0]))
+
+static void bench_parsers(unsigned long iterations)
+{
+    for (size_t p = 0; p < PARSER_COUNT; ++p) {
+        unsigned long errors = 0;
+        unsigned long allocs = alloc_count;
+        uint64_t start = now_ns();
+        for (unsigned long i = 0; i < iterations; ++i)
+            errors += parsers[p].fn(parsers[p].corpus[i & 3]) != 0;
+        report(parsers[p].name, now_ns() - start, iterations, alloc_count - allocs);
+        if (errors)
+            fprintf(stderr, "%s: %lu parse errors\n", parsers[p].name, errors);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Receive path: framer + dispatcher over a stream of mixed AI1 traffic */
+
+static const char *const ai_traffic[] = {
+    /* Fast VFO tuning dominates, with mode/gain/meter traffic mixed in */
+    "FA014074000;", "FA014074010;", "FA014074020;", "FA014074030;",
+    "FB007074000;", "MD02;", "FA014074040;", "AG0128;",
+    "FA014074050;", "RG0255;", "FA014074060;", "SQ0000;",
+    "FA014074070;", "GT01;", "ST0;", "FA014074080;",
+    "CN00012;", "PC100;", "FA014074090;", "MD1C;",
+};
+#define AI_TRAFFIC_COUNT (sizeof(ai_traffic)/sizeof(ai_traffic[0]))
+
+static unsigned long dispatched;
+
+static void on_frames(const cat_frame_t *frames, size_t count, void *user_data)
+{
+    (void)user_data;
+    cat_response_t resp;
+
+    for (size_t i = 0; i < count; ++i)
+        if (cat_dispatch_response(frames[i].data, frames[i].len, &resp) == 0)
+            dispatched++;
+}
+
+static void bench_receive(unsigned long iterations)
+{
+    /* One 64 KiB capture, fed in serial-sized chunks */
+    size_t cap = 64 * 1024, len = 0, frames = 0;
+    char *stream = malloc(cap);
+    if (!stream) return;
+
+    while (len + 16 < cap) {
+        const char *f = ai_traffic[frames % AI_TRAFFIC_COUNT];
+        size_t n = strlen(f);
+        memcpy(stream + len, f, n);
+        len += n;
+        frames++;
+    }
+
+    static cat_framer_t framer;
+    cat_framer_reset(&framer);
+    unsigned long passes = iterations / frames + 1;
+    const size_t chunk = 61;   /* Odd size so frames straddle reads */
+
+    dispatched = 0;
+    unsigned long allocs = alloc_count;
+    uint64_t start = now_ns();
+    for (unsigned long p = 0; p < passes; ++p)
+        for (size_t off = 0; off < len; off += chunk)
+            cat_framer_push(&framer, stream + off, (len - off < chunk) ? len - off : chunk, on_frames, NULL);
+    uint64_t elapsed = now_ns() - start;
+
+    report("receive_frame_dispatch", elapsed, passes * frames, alloc_count - allocs);
+    if (dispatched != passes * frames)
+        fprintf(stderr, "receive: %lu of %lu frames decoded\n", dispatched, passes * frames);
+
+    free(stream);
+}
+
+/* -------------------------------------------------------------------------- */
+static void print_usage(const char *progname)
+{
+    printf("Usage: %s [-n iterations] [-c]\n"
+           "  -n <n>  Iterations per benchmark (default %d)\n"
+           "  -c      CSV output: name,ns_per_op,frames_per_s,allocs_per_op\n",
+           progname, DEFAULT_ITERATIONS);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long iterations = DEFAULT_ITERATIONS;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:ch")) != -1) {
+        switch (opt) {
+            case 'n': {
+                char *endptr = NULL;
+                long v = strtol(optarg, &endptr, 10);
+                if (*endptr != '\0' || v <= 0) {
+                    fprintf(stderr, "Invalid iteration count \"%s\"\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                iterations = (unsigned long)v;
+                break;
+            }
+            case 'c':
+                csv_output = 1;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (csv_output)
+        puts("name,ns_per_op,frames_per_s,allocs_per_op");
+    else
+        printf("FTX-1 CAT codec benchmark, %lu iterations\n", iterations);
+
+    bench_builders(iterations);
+    bench_encoder(iterations);
+    bench_parsers(iterations);
+    bench_receive(iterations);
+
+    return EXIT_SUCCESS;
+}
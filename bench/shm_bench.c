@@ -0,0 +1,205 @@
+/*
+ * shm_bench.c - radio state snapshots through shared memory
+ *
+ * A writer thread publishes a radio_state_t as fast as it can through
+ * radios/radio_shm.h while the main thread reads snapshots for a few
+ * seconds. Every publication keeps both VFO frequencies equal, so a torn
+ * copy would show up as a mismatch; the bench reports reads per second,
+ * the cost of one read and how often the seqlock made a reader retry.
+ * -r sets the publication rate instead of publishing flat out.
+ *
+ * -p prints the state published by a running serial-send -m or radio-ui
+ * --shm instead, which is also the smallest example of a reader.
+ *
+ * Build and run:  make bench-shm
+ * Options:        shm_bench [-s <seconds>] [-r <publications/s>]
+ *                 shm_bench -p [name]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "radios/cat_framer.h"
+#include "radios/radio_shm.h"
+
+typedef struct {
+    radio_shm_t shm;
+    long rate;                  /* Publications per second, 0 = flat out */
+    volatile int stop;
+    uint64_t published;
+} writer_t;
+
+static void *writer_thread(void *arg)
+{
+    writer_t *w = arg;
+    radio_state_t state;
+    radio_state_reset(&state);
+    state.valid = RADIO_FIELD_FREQUENCY | RADIO_VFO_FIELD(RADIO_FIELD_FREQUENCY, VFO_SUB);
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!w->stop) {
+        uint32_t f = 14000000u + (uint32_t)(w->published % 350000u);
+        state.vfo[VFO_MAIN].frequency = f;
+        state.vfo[VFO_SUB].frequency = f;
+        state.updates = w->published;
+        radio_shm_publish(&w->shm, &state);
+        w->published++;
+
+        if (w->rate) {
+            next.tv_nsec += 1000000000l / w->rate;
+            while (next.tv_nsec >= 1000000000l) {
+                next.tv_nsec -= 1000000000l;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+    }
+    return NULL;
+}
+
+static int run_bench(double seconds, long rate)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/shm-bench-%d", (int)getpid());
+
+    static writer_t w;
+    w.rate = rate;
+    if (radio_shm_create(&w.shm, name) < 0) {
+        perror("shm_open");
+        return -1;
+    }
+    radio_shm_t reader;
+    if (radio_shm_open(&reader, name) < 0) {
+        perror("radio_shm_open");
+        radio_shm_close(&w.shm);
+        return -1;
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, writer_thread, &w) != 0) {
+        perror("pthread_create");
+        radio_shm_close(&reader);
+        radio_shm_close(&w.shm);
+        return -1;
+    }
+
+    uint64_t reads = 0, torn = 0, failed = 0, changes = 0;
+    uint32_t last_seq = 0;
+    uint64_t begin = cat_monotonic_ns();
+    uint64_t end = begin + (uint64_t)(seconds * 1e9);
+    uint64_t now = begin;
+    while (now < end) {
+        /* Check the clock every 4096 reads, it costs more than a read */
+        for (int i = 0; i < 4096; i++) {
+            radio_state_t state;
+            if (radio_shm_read(&reader, &state, NULL) < 0) {
+                failed++;
+                continue;
+            }
+            reads++;
+            torn += state.vfo[VFO_MAIN].frequency != state.vfo[VFO_SUB].frequency;
+
+            uint32_t seq = radio_shm_sequence(&reader);
+            changes += seq != last_seq;
+            last_seq = seq;
+        }
+        now = cat_monotonic_ns();
+    }
+    w.stop = 1;
+    pthread_join(thread, NULL);
+
+    double elapsed = (now - begin) / 1e9;
+    printf("%.1f s: %llu publication(s), %llu read(s) (%.1f M/s, %.1f ns each)\n",
+           elapsed, (unsigned long long)w.published, (unsigned long long)reads,
+           reads / elapsed / 1e6, elapsed * 1e9 / (double)(reads ? reads : 1));
+    printf("%llu read(s) saw a new publication, %llu torn, %llu gave up\n",
+           (unsigned long long)changes, (unsigned long long)torn, (unsigned long long)failed);
+
+    radio_shm_close(&reader);
+    radio_shm_close(&w.shm);
+    return torn ? -1 : 0;
+}
+
+static int print_state(const char *name)
+{
+    radio_shm_t shm;
+    if (radio_shm_open(&shm, name) < 0) {
+        fprintf(stderr, "%s: %s\n", name,
+                errno == ENOENT ? "nothing published under that name" :
+                errno == EPROTO ? "published by an incompatible build" : strerror(errno));
+        return -1;
+    }
+
+    radio_state_t state;
+    uint64_t updated_ns;
+    if (radio_shm_read(&shm, &state, &updated_ns) < 0) {
+        fprintf(stderr, "%s: no consistent snapshot, writer stuck\n", name);
+        radio_shm_close(&shm);
+        return -1;
+    }
+
+    printf("%s, writer pid %d, %u publication(s), last %.1f ms ago\n", name, (int)shm.seg->writer_pid,
+           radio_shm_sequence(&shm), updated_ns ? (cat_monotonic_ns() - updated_ns) / 1e6 : 0.0);
+    for (int vfo = VFO_MAIN; vfo <= VFO_SUB; vfo++) {
+        const vfo_state_t *v = &state.vfo[vfo];
+        printf("  %s  ", vfo == VFO_MAIN ? "Main" : "Sub ");
+        if (radio_state_has(&state, RADIO_VFO_FIELD(RADIO_FIELD_FREQUENCY, vfo)))
+            printf("%u Hz", v->frequency);
+        else
+            printf("---");
+        if (radio_state_has(&state, RADIO_VFO_FIELD(RADIO_FIELD_MODE, vfo)))
+            printf("  %s", cat_mode_to_string(v->mode));
+        putchar('\n');
+    }
+    if (radio_state_has(&state, RADIO_FIELD_POWER))
+        printf("  Power %u W\n", state.power);
+    if (radio_state_has(&state, RADIO_FIELD_SPLIT))
+        printf("  Split %s\n", state.split ? "on" : "off");
+
+    radio_shm_close(&shm);
+    return 0;
+}
+
+static void print_usage(const char *progname)
+{
+    printf("Usage: %s [-s seconds] [-r publications/s]\n"
+           "       %s -p [name]\n"
+           "  -s <seconds>  Length of the run (default 3)\n"
+           "  -r <rate>     Publications per second (default: as fast as possible)\n"
+           "  -p [name]     Print the state published under name (default %s)\n",
+           progname, progname, RADIO_SHM_DEFAULT_NAME);
+}
+
+int main(int argc, char *argv[])
+{
+    double seconds = 3.0;
+    long rate = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:r:ph")) != -1) {
+        switch (opt) {
+            case 's': seconds = atof(optarg); break;
+            case 'r': rate = atol(optarg); break;
+            case 'p': {
+                const char *name = optind < argc ? argv[optind] : RADIO_SHM_DEFAULT_NAME;
+                return print_state(name) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+            }
+            case 'h':
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (seconds <= 0 || rate < 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    return run_bench(seconds, rate) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,227 @@
+/*
+ * snapshot_bench.c - sequential vs pipelined cat_snapshot_read()
+ *
+ * Reads the full 16-value snapshot from a simulated FTX-1 on a socket
+ * pair, once with one read in flight (the old request/answer loop) and
+ * then with deeper pipelines. The simulated radio answers in order with
+ * a fixed processing time, the wire time of each answer at the chosen
+ * baud rate, and a one-way link latency standing in for the USB-serial
+ * bridge's latency timer.
+ *
+ * Build and run:  make bench-snapshot
+ * Options:        -b <baud> -l <link latency us> -p <processing us>
+ *                 -r <repetitions> -c (CSV output)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "radios/ftx1_cat.h"
+#include "radios/cat_framer.h"
+#include "radios/cat_snapshot.h"
+
+#define SIM_QUEUE 64
+
+static int baudrate = 38400;
+static uint64_t link_ns = 4000000;     /* One way */
+static uint64_t process_ns = 1000000;
+static int csv_output;
+
+/* -------------------------------------------------------------------------- */
+/* Simulated radio */
+
+typedef struct {
+    char text[CAT_FRAMER_MAX_FRAME];
+    size_t len;
+    uint64_t deliver_ns;
+} sim_answer_t;
+
+typedef struct {
+    int fd;
+    volatile int stop;
+    uint64_t busy_ns;           /* Radio finishes its current answer at this time */
+    sim_answer_t queue[SIM_QUEUE];
+    size_t head, tail;
+    cat_framer_t framer;
+} sim_radio_t;
+
+/* Canned answers, 'v' is replaced by the VFO digit of the request */
+static const char *const answers[] = {
+    "FA014074000;", "FB007074000;", "MDv2;", "AGv128;", "RGv255;", "SQv000;",
+    "GTv1;", "CNv0012;", "PC100;", "ST0;",
+};
+#define ANSWER_COUNT (sizeof(answers)/sizeof(answers[0]))
+
+static size_t build_answer(const char *frame, size_t len, char *out)
+{
+    for (size_t i = 0; i < ANSWER_COUNT; ++i) {
+        if (answers[i][0] != frame[0] || answers[i][1] != frame[1])
+            continue;
+        size_t n = strlen(answers[i]);
+        memcpy(out, answers[i], n);
+        if (out[2] == 'v')
+            out[2] = len > 3 ? frame[2] : '0';
+        return n;
+    }
+    memcpy(out, "?;", 2);
+    return 2;
+}
+
+static void on_sim_frames(const cat_frame_t *frames, size_t count, void *user_data)
+{
+    sim_radio_t *sim = user_data;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (sim->head - sim->tail == SIM_QUEUE)
+            return;
+        sim_answer_t *a = &sim->queue[sim->head++ % SIM_QUEUE];
+        a->len = build_answer(frames[i].data, frames[i].len, a->text);
+
+        /* In order: the radio starts once the command arrived and it is free */
+        uint64_t start = frames[i].rx_ns + link_ns;
+        if (start < sim->busy_ns)
+            start = sim->busy_ns;
+        sim->busy_ns = start + process_ns + a->len * 10ull * 1000000000ull / (uint64_t)baudrate;
+        a->deliver_ns = sim->busy_ns + link_ns;
+    }
+}
+
+static void *sim_thread(void *arg)
+{
+    sim_radio_t *sim = arg;
+
+    while (!sim->stop) {
+        int timeout = 10;
+        if (sim->head != sim->tail) {
+            uint64_t now = cat_monotonic_ns();
+            uint64_t due = sim->queue[sim->tail % SIM_QUEUE].deliver_ns;
+            timeout = due > now ? (int)((due - now) / 1000000) : 0;
+        }
+
+        struct pollfd pfd = { .fd = sim->fd, .events = POLLIN };
+        if (poll(&pfd, 1, timeout) > 0 && cat_framer_read_fd(&sim->framer, sim->fd, on_sim_frames, sim) <= 0)
+            break;
+
+        /* Spin out the last sub-millisecond so delivery times stay exact */
+        uint64_t now = cat_monotonic_ns();
+        while (sim->head != sim->tail) {
+            sim_answer_t *a = &sim->queue[sim->tail % SIM_QUEUE];
+            if (a->deliver_ns > now) {
+                if (a->deliver_ns - now > 1000000)
+                    break;
+                while ((now = cat_monotonic_ns()) < a->deliver_ns)
+                    ;
+            }
+            if (write(sim->fd, a->text, a->len) != (ssize_t)a->len)
+                return NULL;
+            sim->tail++;
+        }
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+static void print_usage(const char *progname)
+{
+    printf("Usage: %s [-b baud] [-l latency_us] [-p processing_us] [-r repetitions] [-c]\n"
+           "  -b <baud>  Simulated line speed (default 38400)\n"
+           "  -l <us>    One-way link latency (default 4000)\n"
+           "  -p <us>    Radio processing time per command (default 1000)\n"
+           "  -r <n>     Snapshots per depth (default 5)\n"
+           "  -c         CSV output: depth,ms_per_snapshot,speedup\n",
+           progname);
+}
+
+static long parse_positive(const char *arg, const char *what)
+{
+    char *endptr = NULL;
+    long v = strtol(arg, &endptr, 10);
+    if (*endptr != '\0' || v < 0) {
+        fprintf(stderr, "Invalid %s \"%s\"\n", what, arg);
+        exit(EXIT_FAILURE);
+    }
+    return v;
+}
+
+int main(int argc, char *argv[])
+{
+    long repetitions = 5;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:l:p:r:ch")) != -1) {
+        switch (opt) {
+            case 'b': baudrate = (int)parse_positive(optarg, "baud rate"); break;
+            case 'l': link_ns = (uint64_t)parse_positive(optarg, "latency") * 1000; break;
+            case 'p': process_ns = (uint64_t)parse_positive(optarg, "processing time") * 1000; break;
+            case 'r': repetitions = parse_positive(optarg, "repetition count"); break;
+            case 'c': csv_output = 1; break;
+            case 'h':
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (baudrate <= 0 || repetitions <= 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        perror("socketpair");
+        return EXIT_FAILURE;
+    }
+
+    static sim_radio_t sim;
+    sim.fd = sv[1];
+    cat_framer_reset(&sim.framer);
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, sim_thread, &sim) != 0) {
+        perror("pthread_create");
+        return EXIT_FAILURE;
+    }
+
+    if (csv_output)
+        puts("depth,ms_per_snapshot,speedup");
+    else
+        printf("Snapshot of %d values, %d baud, %.1f ms link, %.1f ms processing\n",
+               CAT_SNAPSHOT_READS, baudrate, link_ns / 1e6, process_ns / 1e6);
+
+    static const size_t depths[] = { 1, 2, 4, 8, 16 };
+    double sequential_ms = 0;
+    int status = EXIT_SUCCESS;
+
+    for (size_t d = 0; d < sizeof(depths)/sizeof(depths[0]); ++d) {
+        uint64_t total = 0;
+        for (long r = 0; r < repetitions; ++r) {
+            cat_snapshot_t snap;
+            if (cat_snapshot_read(sv[0], &snap, depths[d], 2000) != 0) {
+                fprintf(stderr, "depth %zu: snapshot incomplete (valid 0x%04x, %u failed)\n",
+                        depths[d], snap.valid, snap.failed);
+                status = EXIT_FAILURE;
+            }
+            total += snap.elapsed_ns;
+        }
+
+        double ms = total / 1e6 / (double)repetitions;
+        if (d == 0)
+            sequential_ms = ms;
+        if (csv_output)
+            printf("%zu,%.2f,%.2f\n", depths[d], ms, sequential_ms / ms);
+        else
+            printf("  %-12s depth %2zu %9.2f ms/snapshot %7.2fx\n",
+                   d == 0 ? "sequential" : "pipelined", depths[d], ms, sequential_ms / ms);
+    }
+
+    sim.stop = 1;
+    pthread_join(thread, NULL);
+    close(sv[0]);
+    close(sv[1]);
+    return status;
+}
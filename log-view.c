@@ -0,0 +1,126 @@
+#include "log-view.h"
+#include <string.h>
+#include <time.h>
+
+// Lines removed per trim once the buffer is over its cap
+static guint trim_chunk(const LogView *log) {
+    return log->max_lines / 8 > 0 ? log->max_lines / 8 : 1;
+}
+
+void log_view_init(LogView *log, GtkWidget *view, guint max_lines) {
+    memset(log, 0, sizeof(*log));
+    log->view = view;
+    log->buffer = view ? gtk_text_view_get_buffer(GTK_TEXT_VIEW(view)) : NULL;
+    if (log->buffer) {
+        GtkTextIter end;
+        gtk_text_buffer_get_end_iter(log->buffer, &end);
+        log->end_mark = gtk_text_buffer_create_mark(log->buffer, NULL, &end, FALSE);
+    }
+    log->max_lines = max_lines;
+    log->pending = g_string_sized_new(4096);
+    log->stamp_second = -1;
+}
+
+void log_view_set_max_lines(LogView *log, guint max_lines) {
+    log->max_lines = max_lines;
+}
+
+gboolean log_view_has_pending(const LogView *log) {
+    return log->pending_lines > 0;
+}
+
+// Reformat the "[HH:MM:SS] " prefix only when the second changes
+static const gchar *current_stamp(LogView *log) {
+    gint64 second = g_get_real_time() / G_USEC_PER_SEC;
+
+    if (second != log->stamp_second) {
+        time_t t = (time_t)second;
+        struct tm tm;
+        localtime_r(&t, &tm);
+        strftime(log->stamp, sizeof(log->stamp), "[%H:%M:%S] ", &tm);
+        log->stamp_second = second;
+    }
+    return log->stamp;
+}
+
+// Drop the oldest queued lines so an unflushed backlog (e.g. hidden window) stays bounded
+static void trim_pending(LogView *log) {
+    guint excess = log->pending_lines - log->max_lines + trim_chunk(log);
+    const gchar *p = log->pending->str;
+
+    for (guint i = 0; i < excess; ++i) {
+        p = strchr(p, '\n') + 1;
+    }
+    g_string_erase(log->pending, 0, p - log->pending->str);
+    log->pending_lines -= excess;
+}
+
+// Queue "[HH:MM:SS] <prefix><text>"; nothing touches the widget until the next flush
+void log_view_append(LogView *log, const char *prefix, const char *text, gssize len) {
+    if (len < 0) {
+        len = (gssize)strlen(text);
+    }
+
+    g_string_append(log->pending, current_stamp(log));
+    if (prefix) {
+        g_string_append(log->pending, prefix);
+    }
+    g_string_append_len(log->pending, text, len);
+    g_string_append_c(log->pending, '\n');
+    log->pending_lines++;
+
+    if (log->max_lines && log->pending_lines > log->max_lines + trim_chunk(log)) {
+        trim_pending(log);
+    }
+}
+
+// Insert every queued line with one buffer insert, trim, and scroll once.
+// Returns TRUE if the view changed.
+gboolean log_view_flush(LogView *log) {
+    if (log->pending_lines == 0) {
+        return FALSE;
+    }
+
+    if (!log->buffer) {
+        g_string_truncate(log->pending, 0);
+        log->pending_lines = 0;
+        return FALSE;
+    }
+
+    GtkTextIter iter;
+    gtk_text_buffer_get_end_iter(log->buffer, &iter);
+    gtk_text_buffer_insert(log->buffer, &iter, log->pending->str, (gint)log->pending->len);
+    log->line_count += log->pending_lines;
+    g_string_truncate(log->pending, 0);
+    log->pending_lines = 0;
+
+    // Trim in chunks so the delete (and relayout) happens rarely
+    if (log->max_lines && log->line_count > log->max_lines + trim_chunk(log)) {
+        guint excess = log->line_count - log->max_lines;
+        GtkTextIter start, end;
+        gtk_text_buffer_get_start_iter(log->buffer, &start);
+        gtk_text_buffer_get_iter_at_line(log->buffer, &end, (gint)excess);
+        gtk_text_buffer_delete(log->buffer, &start, &end);
+        log->line_count -= excess;
+    }
+
+    // Auto-scroll to bottom, once per batch
+    gtk_text_view_scroll_mark_onscreen(GTK_TEXT_VIEW(log->view), log->end_mark);
+    return TRUE;
+}
+
+void log_view_clear(LogView *log) {
+    g_string_truncate(log->pending, 0);
+    log->pending_lines = 0;
+    log->line_count = 0;
+    if (log->buffer) {
+        gtk_text_buffer_set_text(log->buffer, "", -1);
+    }
+}
+
+void log_view_free(LogView *log) {
+    if (log->pending) {
+        g_string_free(log->pending, TRUE);
+        log->pending = NULL;
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef LOG_VIEW_H
+#define LOG_VIEW_H
+
+#include <gtk/gtk.h>
+
+#define LOG_VIEW_DEFAULT_MAX_LINES 5000
+
+// Bounded, batched log behind a GtkTextView.
+// Lines are queued with a cached timestamp and inserted once per frame by
+// log_view_flush(); the oldest lines are trimmed in chunks past max_lines.
+typedef struct {
+    GtkWidget *view;          // GtkTextView, may be NULL (lines are then dropped)
+    GtkTextBuffer *buffer;
+    GtkTextMark *end_mark;    // Right-gravity mark that follows the end of the log
+    guint max_lines;          // 0 = unbounded
+    guint line_count;         // Lines currently in the buffer
+    GString *pending;         // Lines waiting for the next flush
+    guint pending_lines;
+    gint64 stamp_second;      // Second the cached stamp was formatted for
+    gchar stamp[16];          // "[HH:MM:SS] "
+} LogView;
+
+void log_view_init(LogView *log, GtkWidget *view, guint max_lines);
+void log_view_set_max_lines(LogView *log, guint max_lines);
+void log_view_append(LogView *log, const char *prefix, const char *text, gssize len);
+gboolean log_view_flush(LogView *log);
+gboolean log_view_has_pending(const LogView *log);
+void log_view_clear(LogView *log);
+void log_view_free(LogView *log);
+
+#endif /* LOG_VIEW_H */
@@ -4,15 +4,28 @@
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
-#include <termios.h>
 #include <errno.h>
 #include <glib.h>
 #include <sys/types.h>
 #include "radios/ftx1_cat.h"
+#include "radios/cat_framer.h"
+#include "serial/serial_io.h"
+#include "serial/transport.h"
+#include "radios/cat_rtt.h"
+#include "radios/cat_session.h"
+#include "radios/cat_pipeline.h"
+#include "radios/cat_poller.h"
+#include "radios/cat_snapshot.h"
+#include "log-view.h"
+#include "radios/radio_state.h"
+#include "radios/cat_capture.h"
+#include "radios/cat_cache.h"
+#include "radios/radio_shm.h"
 
 // Serial communication structures and functions
 typedef struct {
     int fd;
+    transport_t port;       // Owns fd: tty, or a pty/tcp/replay stand-in for the radio
     gboolean connected;
     GtkBuilder *builder;
     GtkWidget *main_window;
@@ -21,38 +34,60 @@ typedef struct {
     GtkWidget *connect_button;
     GtkWidget *disconnect_button;
     GtkWidget *status_label;
+    GtkWidget *frequency_label;
+    GtkWidget *ptt_button;
     GtkWidget *send_button;
     GtkWidget *clear_button;
     GtkWidget *bye_button;
     GtkWidget *response_textview;
-    GtkTextBuffer *response_buffer;
-    guint read_source_id;
+    LogView log;                // Bounded, batched model behind response_textview
+    guint frame_tick_id;        // Pending frame-clock callback, 0 if none
+    serial_io_t io;         // Reader thread: frames the port and hands them over
+    serial_io_t io2;        // Reader thread for CAT-2, only when --cat2 is given
+    int cat2_fd;            // Standard COM port (PTT, keying), -1 if not open
+    transport_t cat2_port;
+    const gchar *cat2_device;
+    int cat2_baudrate;
+    cat_session_t session;  // Routes TX control to CAT-2, one write queue per port
+    cat_ptt_method_t ptt_method;
+    guint write_source_id[CAT_PORT_COUNT];  // G_IO_OUT watches while a queue has a backlog
+    cat_pipeline_t pipeline;    // Reads in flight, answers paired by opcode + VFO
+    cat_cache_t cache;          // Recent answers and AI pushes, serve polls without the bus
+    gboolean use_cache;
+    guint poller_timer_id;      // Periodic poller tick
+    guint deadline_source_id;   // One-shot timeout at the earliest read deadline
+    guint64 deadline_at;
+    cat_poller_t poller;        // Background reads, each at its own rate within a bus budget
+    cat_snapshot_t snapshot;    // Full state read in one burst on connect
+    radio_state_t radio;    // Live radio state decoded from AI1 pushes and answers
+    radio_shm_t shm;        // --shm: radio published to local readers, seg NULL when off
+    cat_capture_t capture;  // --capture: raw traffic of both ports, fd -1 when off
+    cat_rtt_t rtt;          // Reads in flight, paired with their answers for latency
+    int baudrate;
 } AppData;
 
-// Baud rate table
-static const struct {
-    int baud;
-    speed_t constant;
-} baud_table[] = {
-    { 1200,   B1200   },
-    { 2400,   B2400   },
-    { 4800,   B4800   },
-    { 9600,   B9600   },
-    { 19200,  B19200  },
-    { 38400,  B38400  },
-    { 57600,  B57600  },
-    { 115200, B115200 },
-    { 230400, B230400 },
-    { 460800, B460800 },
-    { 921600, B921600 }
-};
-#define BAUD_TABLE_SIZE (sizeof(baud_table)/sizeof(baud_table[0]))
-
 // Function prototypes
 static void append_to_response(AppData *app_data, const char *text);
-static int init_serial(const char *device, int baudrate);
-static speed_t baud_to_constant(int baud);
-static gboolean serial_read_callback(GIOChannel *source, GIOCondition condition, gpointer data);
+static int init_serial(AppData *app_data, transport_t *t, const char *device, int baudrate);
+static void wake_main_loop(void *data);
+static gboolean drain_serial_io(gpointer data);
+static void on_frames_received(const cat_frame_t *frames, size_t count, void *data);
+static void schedule_frame_update(AppData *app_data);
+static gboolean on_frame_tick(GtkWidget *widget, GdkFrameClock *frame_clock, gpointer data);
+static void update_radio_display(AppData *app_data);
+static int send_wire(AppData *app_data, const cat_command_t *cmds, size_t count);
+static void show_latency(AppData *app_data, const cat_frame_t *frame, int64_t rtt_ns);
+static gboolean flush_session(AppData *app_data);
+static gboolean serial_write_callback(GIOChannel *source, GIOCondition condition, gpointer data);
+static void close_cat2(AppData *app_data);
+static void close_port(AppData *app_data);
+static int queue_frame(const char *frame, size_t len, void *data);
+static void refresh_radio(AppData *app_data);
+static void on_snapshot_done(cat_snapshot_t *snap, void *data);
+static gboolean on_poller_timer(gpointer data);
+static void arm_deadline(AppData *app_data);
+static gboolean on_deadline(gpointer data);
+static void setup_poller(AppData *app_data, int baudrate);
 static void on_command_activate(GtkEntry *entry, gpointer data);
 static gboolean is_dark_theme(void);
 static void apply_adaptive_theme(void);
@@ -61,120 +96,437 @@ static void apply_adaptive_theme(void);
 void on_connect_clicked(GtkWidget *widget, gpointer data);
 void on_disconnect_clicked(GtkWidget *widget, gpointer data);
 void on_send_command(GtkWidget *widget, gpointer data);
+void on_ptt_toggled(GtkToggleButton *button, gpointer data);
 void on_clear_clicked(GtkWidget *widget, gpointer data);
 void on_bye_clicked(GtkWidget *widget, gpointer data);
 
-static speed_t baud_to_constant(int baud) {
-    for (size_t i = 0; i < BAUD_TABLE_SIZE; ++i) {
-        if (baud_table[i].baud == baud) {
-            return baud_table[i].constant;
+// Open a serial port or a simulated one (pty:, tcp:, replay:); logs what was actually applied
+static int init_serial(AppData *app_data, transport_t *t, const char *device, int baudrate) {
+    char report[256];
+
+    if (transport_open(t, device, baudrate) < 0) {
+        perror(device);
+        return -1;
+    }
+
+    transport_describe(t, report, sizeof(report));
+    append_to_response(app_data, report);
+    return t->fd;
+}
+
+// Apply pending UI changes at most once per displayed frame
+static gboolean on_frame_tick(GtkWidget *widget, GdkFrameClock *frame_clock, gpointer data) {
+    (void)widget;  // Mark as intentionally unused
+    (void)frame_clock;
+    AppData *app_data = (AppData *)data;
+
+    app_data->frame_tick_id = 0;
+    if (radio_state_take_dirty(&app_data->radio)) {
+        update_radio_display(app_data);
+    }
+    log_view_flush(&app_data->log);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void schedule_frame_update(AppData *app_data) {
+    if (!app_data->frame_tick_id) {
+        app_data->frame_tick_id = gtk_widget_add_tick_callback(app_data->main_window, on_frame_tick, app_data, NULL);
+    }
+}
+
+static void append_to_response(AppData *app_data, const char *text) {
+    // Queued with its timestamp; inserted and scrolled on the next frame
+    log_view_append(&app_data->log, NULL, text, -1);
+    schedule_frame_update(app_data);
+}
+
+// Append one VFO line ("Main  14.074.000  USB  AGC FAST") to the display text
+static void append_vfo_line(GString *text, const radio_state_t *radio, vfo_select_t vfo) {
+    const vfo_state_t *state = &radio->vfo[vfo];
+
+    g_string_append(text, vfo == VFO_MAIN ? "Main " : "Sub  ");
+    if (radio_state_has(radio, RADIO_VFO_FIELD(RADIO_FIELD_FREQUENCY, vfo))) {
+        g_string_append_printf(text, "%4u.%03u.%03u", state->frequency / 1000000,
+                               (state->frequency / 1000) % 1000, state->frequency % 1000);
+    } else {
+        g_string_append(text, "  ---.---.---");
+    }
+    if (radio_state_has(radio, RADIO_VFO_FIELD(RADIO_FIELD_MODE, vfo))) {
+        g_string_append_printf(text, "  %s", cat_mode_to_string(state->mode));
+    }
+    if (radio_state_has(radio, RADIO_VFO_FIELD(RADIO_FIELD_AGC, vfo))) {
+        g_string_append_printf(text, "  AGC %s", cat_agc_to_string(state->agc));
+    }
+    if (radio_state_has(radio, RADIO_VFO_FIELD(RADIO_FIELD_AF_GAIN, vfo))) {
+        g_string_append_printf(text, "  AF %u", state->af_gain);
+    }
+    if (radio_state_has(radio, RADIO_VFO_FIELD(RADIO_FIELD_RF_GAIN, vfo))) {
+        g_string_append_printf(text, "  RF %u", state->rf_gain);
+    }
+    if (radio_state_has(radio, RADIO_VFO_FIELD(RADIO_FIELD_SQUELCH, vfo))) {
+        g_string_append_printf(text, "  SQL %u", state->squelch);
+    }
+    if (radio_state_has(radio, RADIO_VFO_FIELD(RADIO_FIELD_CTCSS, vfo))) {
+        g_string_append_printf(text, "  %s %03u", state->ctcss_type ? "DCS" : "CTCSS", state->ctcss_code);
+    }
+}
+
+// Render the decoded radio state; the display never polls the radio itself
+static void update_radio_display(AppData *app_data) {
+    const radio_state_t *radio = &app_data->radio;
+    GString *text = g_string_new(NULL);
+
+    append_vfo_line(text, radio, VFO_MAIN);
+    g_string_append_c(text, '\n');
+    append_vfo_line(text, radio, VFO_SUB);
+    if (radio_state_has(radio, RADIO_FIELD_SPLIT) && radio->split) {
+        g_string_append(text, "\nSPLIT");
+    }
+    if (radio_state_has(radio, RADIO_FIELD_POWER)) {
+        g_string_append_printf(text, "\nPower %u W", radio->power);
+    }
+
+    gtk_label_set_text(GTK_LABEL(app_data->frequency_label), text->str);
+    g_string_free(text, TRUE);
+}
+
+// Log an answer together with the round trip of the read that asked for it
+static void show_latency(AppData *app_data, const cat_frame_t *frame, int64_t rtt_ns) {
+    const cat_rtt_t *rtt = &app_data->rtt;
+    char line[CAT_FRAMER_MAX_FRAME + 32];
+    char status[128];
+
+    g_snprintf(line, sizeof(line), "%.*s  (%.3f ms)", (int)frame->len, frame->data, rtt_ns / 1e6);
+    log_view_append(&app_data->log, "RECV: ", line, -1);
+
+    g_snprintf(status, sizeof(status), "RTT %.3f ms (avg %.3f, min %.3f, max %.3f) at %d baud",
+               rtt_ns / 1e6, cat_rtt_average_ns(rtt) / 1e6,
+               rtt->min_ns / 1e6, rtt->max_ns / 1e6, app_data->baudrate);
+    gtk_label_set_text(GTK_LABEL(app_data->status_label), status);
+}
+
+static void on_frames_received(const cat_frame_t *frames, size_t count, void *data) {
+    AppData *app_data = (AppData *)data;
+    uint32_t changed = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        int64_t rtt_ns = cat_rtt_match(&app_data->rtt, frames[i].data, frames[i].len, frames[i].rx_ns);
+        if (rtt_ns >= 0) {
+            show_latency(app_data, &frames[i], rtt_ns);
+        } else {
+            log_view_append(&app_data->log, "RECV: ", frames[i].data, (gssize)frames[i].len);
         }
+
+        // Only the state is updated here; the display catches up on the next frame
+        changed |= radio_state_feed(&app_data->radio, frames[i].data, frames[i].len);
+        cat_pipeline_on_frame(&app_data->pipeline, frames[i].data, frames[i].len, frames[i].rx_ns);
+        cat_poller_note_frame(&app_data->poller, frames[i].data, frames[i].len, frames[i].rx_ns);
     }
-    return B38400; // fallback
+
+    // Other processes see the batch at once, not on the next displayed frame
+    if (changed && app_data->shm.seg) {
+        radio_shm_publish(&app_data->shm, &app_data->radio);
+    }
+
+    // Answers freed window slots: send the next reads in one write
+    if (cat_pipeline_pump(&app_data->pipeline)) {
+        flush_session(app_data);
+    }
+    schedule_frame_update(app_data);
 }
 
-static int init_serial(const char *device, int baudrate) {
-    int fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
-    if (fd < 0) {
-        perror("open");
-        return -1;
+// Re-aim the deadline timer, push every port's queue and arm a G_IO_OUT watch for any backlog
+static gboolean flush_session(AppData *app_data) {
+    cat_session_t *session = &app_data->session;
+
+    arm_deadline(app_data);
+    if (cat_session_flush_all(session) < 0) {
+        perror("writev");
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Write error");
+        return FALSE;
     }
+    cat_rtt_sent(&app_data->rtt, session->txq[CAT_PORT_1].tail, session->txq[CAT_PORT_1].last_write_ns);
 
-    struct termios tty;
-    if (tcgetattr(fd, &tty) != 0) {
-        perror("tcgetattr");
-        close(fd);
-        return -1;
+    for (int port = 0; port < CAT_PORT_COUNT; ++port) {
+        if (cat_session_pending(session, port) && !app_data->write_source_id[port]) {
+            GIOChannel *channel = g_io_channel_unix_new(session->fd[port]);
+            app_data->write_source_id[port] = g_io_add_watch(channel, G_IO_OUT, serial_write_callback, app_data);
+            g_io_channel_unref(channel);
+        }
     }
+    return TRUE;
+}
 
-    cfsetospeed(&tty, baud_to_constant(baudrate));
-    cfsetispeed(&tty, baud_to_constant(baudrate));
+static gboolean serial_write_callback(GIOChannel *source, GIOCondition condition, gpointer data) {
+    (void)condition;
+    AppData *app_data = (AppData *)data;
+    cat_session_t *session = &app_data->session;
+    cat_port_t port = g_io_channel_unix_get_fd(source) == session->fd[CAT_PORT_2] ? CAT_PORT_2 : CAT_PORT_1;
 
-    tty.c_cflag &= ~PARENB; // No parity
-    tty.c_cflag &= ~CSTOPB; // 1 stop bit
-    tty.c_cflag &= ~CSIZE;  // Clear data size bits
-    tty.c_cflag |= CS8;     // 8 data bits
-    tty.c_cflag &= ~CRTSCTS; // No hardware flow control
-    tty.c_cflag |= CREAD | CLOCAL; // Enable receiver, ignore modem control lines
+    if (cat_session_flush(session, port) < 0) {
+        perror("writev");
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Write error");
+        app_data->write_source_id[port] = 0;
+        return FALSE;
+    }
+    if (port == CAT_PORT_1) {
+        cat_rtt_sent(&app_data->rtt, session->txq[port].tail, session->txq[port].last_write_ns);
+    }
 
-    tty.c_lflag &= ~ICANON; // Non-canonical mode
-    tty.c_lflag &= ~ECHO;   // No echo
-    tty.c_lflag &= ~ECHOE;  // No echo erase
-    tty.c_lflag &= ~ISIG;   // No signal chars
+    if (!cat_session_pending(session, port)) {
+        app_data->write_source_id[port] = 0;
+        return FALSE;
+    }
+    return TRUE;
+}
 
-    tty.c_iflag &= ~(IXON | IXOFF | IXANY); // No software flow control
-    tty.c_iflag &= ~(IGNBRK|BRKINT|PARMRK|ISTRIP|INLCR|IGNCR|ICRNL);
+// Reader threads hand every raw read to the capture, tagged with its port
+static void capture_rx_cat1(const char *data, size_t len, uint64_t rx_ns, void *user_data) {
+    AppData *app_data = (AppData *)user_data;
+    cat_capture_write(&app_data->capture, CAT_CAPTURE_RX, CAT_PORT_1, rx_ns, data, len);
+}
 
-    tty.c_oflag &= ~OPOST; // No output processing
-    tty.c_oflag &= ~ONLCR; // No \n -> \r\n conversion
+static void capture_rx_cat2(const char *data, size_t len, uint64_t rx_ns, void *user_data) {
+    AppData *app_data = (AppData *)user_data;
+    cat_capture_write(&app_data->capture, CAT_CAPTURE_RX, CAT_PORT_2, rx_ns, data, len);
+}
 
-    tty.c_cc[VTIME] = 1;    // Wait up to 0.1 second
-    tty.c_cc[VMIN] = 0;     // Return immediately with what we have
+// Queue one frame on the port for its class; reads are timed from the write carrying their ';'
+static int queue_frame(const char *frame, size_t len, void *data) {
+    AppData *app_data = (AppData *)data;
+    cat_session_t *session = &app_data->session;
 
-    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
-        perror("tcsetattr");
-        close(fd);
+    int port = cat_session_queue(session, frame, len);
+    if (port < 0) {
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Transmit queue full");
+        return -1;
+    }
+    if (app_data->capture.fd >= 0) {
+        cat_capture_write(&app_data->capture, CAT_CAPTURE_TX, (uint16_t)port, cat_monotonic_ns(), frame, len);
+    }
+    cat_cache_invalidate(&app_data->cache, frame, len);
+    if (port == CAT_PORT_1) {
+        cat_rtt_expect(&app_data->rtt, frame, len, session->txq[CAT_PORT_1].head);
+        // Reads come back here from the pipeline; a set's "?;" must not fail one of them
+        if (!cat_is_read_request(frame, len)) {
+            cat_pipeline_note_set(&app_data->pipeline, NULL, NULL);
+        }
+    }
+    return 0;
+}
+
+// Queue each command on the port for its class, then one write per port
+static int send_wire(AppData *app_data, const cat_command_t *cmds, size_t count) {
+    char wire[8 * CAT_WIRE_MAX];
+    int len = cat_encode_batch(cmds, count, wire, sizeof(wire));
+    if (len < 0) {
+        return -1;
+    }
+
+    const char *frame = wire;
+    for (int i = 0; i < len; ++i) {
+        if (wire[i] != ';') {
+            continue;
+        }
+        if (queue_frame(frame, (size_t)(wire + i + 1 - frame), app_data) != 0) {
+            return -1;
+        }
+        frame = wire + i + 1;
+    }
+
+    if (!flush_session(app_data)) {
         return -1;
     }
 
-    return fd;
+    gchar *sent_msg = g_strdup_printf("SENT: %.*s", len, wire);
+    append_to_response(app_data, sent_msg);
+    g_free(sent_msg);
+    return 0;
 }
 
-static void append_to_response(AppData *app_data, const char *text) {
-    GtkTextIter iter;
-    gtk_text_buffer_get_end_iter(app_data->response_buffer, &iter);
-    
-    // Add timestamp
-    GDateTime *now = g_date_time_new_now_local();
-    gchar *timestamp = g_date_time_format(now, "[%H:%M:%S] ");
-    gtk_text_buffer_insert(app_data->response_buffer, &iter, timestamp, -1);
-    g_free(timestamp);
-    g_date_time_unref(now);
-    
-    // Add the actual text
-    gtk_text_buffer_insert(app_data->response_buffer, &iter, text, -1);
-    gtk_text_buffer_insert(app_data->response_buffer, &iter, "\n", -1);
-    
-    // Auto-scroll to bottom
-    GtkTextMark *mark = gtk_text_buffer_get_insert(app_data->response_buffer);
-    gtk_text_view_scroll_mark_onscreen(GTK_TEXT_VIEW(app_data->response_textview), mark);
+// Runs on the I/O thread, at most once per drain: queue the drain on the main loop
+static void wake_main_loop(void *data) {
+    g_idle_add_full(G_PRIORITY_DEFAULT, drain_serial_io, data, NULL);
 }
 
-static gboolean serial_read_callback(GIOChannel *source, GIOCondition condition, gpointer data) {
-    (void)source; // Mark as intentionally unused
+static gboolean drain_serial_io(gpointer data) {
     AppData *app_data = (AppData *)data;
-    char buffer[256];
-    ssize_t bytes_read;
 
-    if (condition & G_IO_HUP) {
+    if (!app_data->connected) {
+        return G_SOURCE_REMOVE;
+    }
+
+    // Closed flags first: frames published just before a hangup are in this drain, not lost
+    gboolean lost = serial_io_closed(&app_data->io);
+    gboolean lost2 = serial_io_closed(&app_data->io2);
+
+    // Everything the threads framed since the last wake-up, in batches
+    serial_io_drain(&app_data->io, on_frames_received, app_data);
+    serial_io_drain(&app_data->io2, on_frames_received, app_data);
+
+    if (app_data->cat2_fd >= 0 && lost2) {
+        close_cat2(app_data);
+        append_to_response(app_data, "CAT-2 lost, TX control falls back to CAT-1");
+    }
+
+    if (lost) {
+        close_port(app_data);
         append_to_response(app_data, "Connection lost");
         app_data->connected = FALSE;
         gtk_label_set_text(GTK_LABEL(app_data->status_label), "Disconnected");
         gtk_widget_set_sensitive(app_data->connect_button, TRUE);
         gtk_widget_set_sensitive(app_data->disconnect_button, FALSE);
-        return FALSE;
+        gtk_widget_set_sensitive(app_data->ptt_button, FALSE);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+// Read the values AI1 only reports once they change, K at a time instead of one per round trip
+static void refresh_radio(AppData *app_data) {
+    if (app_data->snapshot.outstanding) {
+        return;
+    }
+    if (cat_snapshot_start(&app_data->snapshot, &app_data->pipeline, on_snapshot_done, app_data) == 0 &&
+        cat_pipeline_pump(&app_data->pipeline)) {
+        flush_session(app_data);
+    }
+}
+
+// Every value already reached radio_state through on_frames_received; only report the burst
+static void on_snapshot_done(cat_snapshot_t *snap, void *data) {
+    AppData *app_data = (AppData *)data;
+
+    if (snap->failed) {
+        gchar *msg = g_strdup_printf("%u refresh reads failed", snap->failed);
+        append_to_response(app_data, msg);
+        g_free(msg);
+    }
+
+    gchar *msg = g_strdup_printf("Refreshed %d values in %.1f ms (%zu in flight)",
+                                 CAT_SNAPSHOT_READS - (int)snap->failed, snap->elapsed_ns / 1e6,
+                                 app_data->pipeline.depth);
+    gtk_label_set_text(GTK_LABEL(app_data->status_label), msg);
+    g_free(msg);
+}
+
+static gboolean on_poller_timer(gpointer data) {
+    AppData *app_data = (AppData *)data;
+
+    cat_poller_run(&app_data->poller, &app_data->pipeline, cat_monotonic_ns());
+    if (cat_pipeline_pump(&app_data->pipeline)) {
+        flush_session(app_data);
     }
+    return G_SOURCE_CONTINUE;
+}
+
+// One timeout serves every read in flight: it always points at the earliest deadline
+static void arm_deadline(AppData *app_data) {
+    guint64 next = cat_pipeline_next_deadline(&app_data->pipeline);
+
+    if (app_data->deadline_source_id && next == app_data->deadline_at) {
+        return;
+    }
+    if (app_data->deadline_source_id) {
+        g_source_remove(app_data->deadline_source_id);
+        app_data->deadline_source_id = 0;
+    }
+    if (next == 0) {
+        return;
+    }
+
+    guint64 now = cat_monotonic_ns();
+    guint delay_ms = next > now ? (guint)((next - now + 999999) / 1000000) : 0;
+    app_data->deadline_at = next;
+    app_data->deadline_source_id = g_timeout_add(delay_ms, on_deadline, app_data);
+}
 
-    if (condition & G_IO_IN) {
-        bytes_read = read(app_data->fd, buffer, sizeof(buffer) - 1);
-        if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-            // Remove trailing newlines for cleaner display
-            while (bytes_read > 0 && (buffer[bytes_read-1] == '\n' || buffer[bytes_read-1] == '\r')) {
-                buffer[--bytes_read] = '\0';
-            }
-            if (bytes_read > 0) {
-                gchar *recv_msg = g_strdup_printf("RECV: %s", buffer);
-                append_to_response(app_data, recv_msg);
-                g_free(recv_msg);
-            }
-        } else if (bytes_read < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-            perror("read");
-            return FALSE;
+// Missed answers are sent again with a growing wait, then fail to their callbacks
+static gboolean on_deadline(gpointer data) {
+    AppData *app_data = (AppData *)data;
+    cat_pipeline_t *pipeline = &app_data->pipeline;
+    guint64 failed = pipeline->failed;
+
+    app_data->deadline_source_id = 0;
+    if (cat_pipeline_expire(pipeline, cat_monotonic_ns())) {
+        cat_pipeline_pump(pipeline);
+        if (pipeline->failed > failed) {
+            gchar *msg = g_strdup_printf("%" G_GUINT64_FORMAT " read(s) unanswered after %u tries",
+                                         pipeline->failed - failed, pipeline->max_retries + 1);
+            append_to_response(app_data, msg);
+            g_free(msg);
         }
     }
+    flush_session(app_data);
+    return G_SOURCE_REMOVE;
+}
 
-    return TRUE;
+// Interval, priority and AI coverage per value; the poller stretches them all when answers slow down
+static void setup_poller(AppData *app_data, int baudrate) {
+    cat_poller_t *poller = &app_data->poller;
+    cat_command_t cmd;
+
+    cat_poller_init(poller, baudrate, 50);
+    for (int vfo = VFO_MAIN; vfo <= VFO_SUB; ++vfo) {
+        cat_build_frequency_read(&cmd, vfo);
+        cat_poller_add(poller, &cmd, 1000, 3, true);
+        cat_build_mode_read(&cmd, vfo);
+        cat_poller_add(poller, &cmd, 2000, 3, true);
+        cat_build_af_gain_read(&cmd, vfo);
+        cat_poller_add(poller, &cmd, 1000, 2, false);
+        cat_build_squelch_read(&cmd, vfo);
+        cat_poller_add(poller, &cmd, 2000, 2, false);
+        cat_build_rf_gain_read(&cmd, vfo);
+        cat_poller_add(poller, &cmd, 2000, 1, false);
+    }
+    cat_build_power_read(&cmd);
+    cat_poller_add(poller, &cmd, 2000, 2, false);
+    cat_build_split_read(&cmd);
+    cat_poller_add(poller, &cmd, 2000, 2, false);
+    cat_build_firmware_version_read(&cmd);
+    cat_poller_add(poller, &cmd, 3600000, 0, false);
+    cat_build_radio_info_read(&cmd);
+    cat_poller_add(poller, &cmd, 600000, 0, false);
+    cat_poller_set_auto_info(poller, true);
+
+    // The connect refresh has just read all of this
+    cat_poller_reset(poller, cat_monotonic_ns());
+}
+
+static void close_cat2(AppData *app_data) {
+    if (app_data->cat2_fd < 0) {
+        return;
+    }
+    serial_io_stop(&app_data->io2);
+    if (app_data->write_source_id[CAT_PORT_2]) {
+        g_source_remove(app_data->write_source_id[CAT_PORT_2]);
+        app_data->write_source_id[CAT_PORT_2] = 0;
+    }
+    transport_close(&app_data->cat2_port);
+    app_data->cat2_fd = -1;
+    app_data->session.fd[CAT_PORT_2] = -1;
+}
+
+// Stop the readers, drop pending output and close both ports
+static void close_port(AppData *app_data) {
+    if (app_data->poller_timer_id) {
+        g_source_remove(app_data->poller_timer_id);
+        app_data->poller_timer_id = 0;
+    }
+    if (app_data->deadline_source_id) {
+        g_source_remove(app_data->deadline_source_id);
+        app_data->deadline_source_id = 0;
+    }
+    app_data->snapshot.done = NULL;     // Cancelled reads must not touch the status line
+    cat_pipeline_cancel(&app_data->pipeline);
+    close_cat2(app_data);
+    serial_io_stop(&app_data->io);
+    if (app_data->write_source_id[CAT_PORT_1]) {
+        g_source_remove(app_data->write_source_id[CAT_PORT_1]);
+        app_data->write_source_id[CAT_PORT_1] = 0;
+    }
+    transport_close(&app_data->port);
 }
 
 // Signal handlers - these names must match the Glade file
@@ -190,13 +542,58 @@ void on_connect_clicked(GtkWidget *widget, gpointer data) {
         return;
     }
 
-    app_data->fd = init_serial(device, baudrate);
+    app_data->fd = init_serial(app_data, &app_data->port, device, baudrate);
     if (app_data->fd < 0) {
         gtk_label_set_text(GTK_LABEL(app_data->status_label), "Failed to connect");
         return;
     }
 
+    // Reads happen on their own thread so a busy UI cannot overflow the tty buffer
+    gboolean capturing = app_data->capture.fd >= 0;
+    if (serial_io_start_tapped(&app_data->io, app_data->fd, wake_main_loop, app_data,
+                               capturing ? capture_rx_cat1 : NULL, app_data) != 0) {
+        transport_close(&app_data->port);
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Failed to start reader thread");
+        return;
+    }
+
+    // Optional CAT-2: TX control gets its own port and queue
+    app_data->cat2_fd = -1;
+    if (app_data->cat2_device) {
+        app_data->cat2_fd = init_serial(app_data, &app_data->cat2_port, app_data->cat2_device,
+                                        app_data->cat2_baudrate);
+        if (app_data->cat2_fd >= 0 &&
+            serial_io_start_tapped(&app_data->io2, app_data->cat2_fd, wake_main_loop, app_data,
+                                   capturing ? capture_rx_cat2 : NULL, app_data) != 0) {
+            transport_close(&app_data->cat2_port);
+            app_data->cat2_fd = -1;
+        }
+        if (app_data->cat2_fd < 0) {
+            append_to_response(app_data, "Failed to open CAT-2, TX control stays on CAT-1");
+        }
+    }
+    cat_session_init(&app_data->session, app_data->fd, app_data->cat2_fd);
+    app_data->session.ptt_method = app_data->ptt_method;
+    cat_pipeline_init(&app_data->pipeline, CAT_PIPELINE_DEFAULT_DEPTH, queue_frame, app_data);
+    cat_cache_init(&app_data->cache);
+    if (app_data->use_cache) {
+        cat_pipeline_set_cache(&app_data->pipeline, &app_data->cache);
+    }
+    // A full window of answers must fit in the first deadline at slow baud rates
+    cat_pipeline_set_deadline(&app_data->pipeline,
+                              CAT_PIPELINE_TIMEOUT_NS + CAT_PIPELINE_DEFAULT_DEPTH * 16 * 10 * 1000000000ull / baudrate,
+                              CAT_PIPELINE_RETRIES, CAT_PIPELINE_MAX_TIMEOUT_NS);
+    setup_poller(app_data, baudrate);
+    app_data->poller_timer_id = g_timeout_add(100, on_poller_timer, app_data);
+
     app_data->connected = TRUE;
+    app_data->baudrate = baudrate;
+    cat_rtt_reset(&app_data->rtt);
+    radio_state_reset(&app_data->radio);
+    if (app_data->shm.seg) {
+        radio_shm_publish(&app_data->shm, &app_data->radio);
+    }
+    update_radio_display(app_data);
     gchar *status_text = g_strdup_printf("Connected to %s at %d baud", device, baudrate);
     gtk_label_set_text(GTK_LABEL(app_data->status_label), status_text);
     g_free(status_text);
@@ -204,20 +601,16 @@ void on_connect_clicked(GtkWidget *widget, gpointer data) {
     gtk_widget_set_sensitive(app_data->connect_button, FALSE);
     gtk_widget_set_sensitive(app_data->disconnect_button, TRUE);
     gtk_widget_set_sensitive(app_data->send_button, TRUE);
+    gtk_widget_set_sensitive(app_data->ptt_button, TRUE);
 
-    GIOChannel *channel = g_io_channel_unix_new(app_data->fd);
-    g_io_channel_set_encoding(channel, NULL, NULL);
-    g_io_channel_set_flags(channel, G_IO_FLAG_NONBLOCK, NULL);
-    app_data->read_source_id = g_io_add_watch(channel, G_IO_IN | G_IO_HUP, serial_read_callback, app_data);
-    g_io_channel_unref(channel);
     
     append_to_response(app_data, "Connected successfully");
     
-    // Send AI1; command to enable auto info
-    const char *ai_cmd = "AI1;\n";
-    if (write(app_data->fd, ai_cmd, strlen(ai_cmd)) > 0) {
-        append_to_response(app_data, "SENT: AI1;");
-    }
+    // Enable auto info, then read the values AI1 only reports once they change
+    cat_command_t auto_info;
+    cat_build_auto_info_set(&auto_info, true);
+    send_wire(app_data, &auto_info, 1);
+    refresh_radio(app_data);
 }
 
 void on_disconnect_clicked(GtkWidget *widget, gpointer data) {
@@ -225,16 +618,13 @@ void on_disconnect_clicked(GtkWidget *widget, gpointer data) {
     AppData *app_data = (AppData *)data;
 
     if (app_data->connected) {
-        if (app_data->read_source_id) {
-            g_source_remove(app_data->read_source_id);
-            app_data->read_source_id = 0;
-        }
-        close(app_data->fd);
+        close_port(app_data);
         app_data->connected = FALSE;
         gtk_label_set_text(GTK_LABEL(app_data->status_label), "Disconnected");
         gtk_widget_set_sensitive(app_data->connect_button, TRUE);
         gtk_widget_set_sensitive(app_data->disconnect_button, FALSE);
         gtk_widget_set_sensitive(app_data->send_button, FALSE);
+        gtk_widget_set_sensitive(app_data->ptt_button, FALSE);
         append_to_response(app_data, "Disconnected");
     }
 }
@@ -248,27 +638,35 @@ void on_send_command(GtkWidget *widget, gpointer data) {
         return;
     }
 
-    // Send FA; command to read VFO A frequency
-    const char *command = "FA;";
-    
-    // Log the command being sent
-    gchar *sent_msg = g_strdup_printf("SENT: %s", command);
-    append_to_response(app_data, sent_msg);
-    g_free(sent_msg);
+    // The display follows the AI1 stream; only ask the radio if nothing has arrived yet
+    if (!radio_state_has(&app_data->radio, RADIO_FIELD_FREQUENCY)) {
+        if (cat_pipeline_pending(&app_data->pipeline) == 0) {
+            refresh_radio(app_data);
+        }
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Refresh requested");
+        return;
+    }
 
-    // Send command
-    size_t len = strlen(command);
-    if (write(app_data->fd, command, len) != (ssize_t)len) {
-        perror("write");
-        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Write error");
+    update_radio_display(app_data);
+    gtk_label_set_text(GTK_LABEL(app_data->status_label), "Display refreshed");
+}
+
+// PTT goes out on CAT-2 when it is open, ahead of anything queued on CAT-1
+void on_ptt_toggled(GtkToggleButton *button, gpointer data) {
+    AppData *app_data = (AppData *)data;
+    gboolean transmit = gtk_toggle_button_get_active(button);
+
+    if (!app_data->connected || app_data->session.transmitting == (bool)transmit) {
         return;
     }
-    
-    // Add newline
-    write(app_data->fd, "\n", 1);
-    
-    // Update status
-    gtk_label_set_text(GTK_LABEL(app_data->status_label), "Command sent");
+
+    if (cat_session_set_ptt(&app_data->session, transmit) != 0) {
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "PTT failed");
+        gtk_toggle_button_set_active(button, app_data->session.transmitting);
+        return;
+    }
+    flush_session(app_data);
+    append_to_response(app_data, transmit ? "PTT: TX" : "PTT: RX");
 }
 
 static void on_command_activate(GtkEntry *entry, gpointer data) {
@@ -279,7 +677,7 @@ static void on_command_activate(GtkEntry *entry, gpointer data) {
 void on_clear_clicked(GtkWidget *widget, gpointer data) {
     (void)widget;  // Mark as intentionally unused
     AppData *app_data = (AppData *)data;
-    gtk_text_buffer_set_text(app_data->response_buffer, "", -1);
+    log_view_clear(&app_data->log);
 }
 
 void on_bye_clicked(GtkWidget *widget, gpointer data) {
@@ -359,12 +757,64 @@ static void apply_adaptive_theme(void) {
 }
 
 int main(int argc, char *argv[]) {
-    gtk_init(&argc, &argv);
+    gint log_lines = LOG_VIEW_DEFAULT_MAX_LINES;
+    gchar *cat2_device = NULL;
+    gint cat2_baud = 4800;
+    gchar *ptt_method = NULL;
+    gchar *capture_path = NULL;
+    gboolean no_cache = FALSE;
+    gchar *shm_name = NULL;
+    GOptionEntry options[] = {
+        { "log-lines", 'l', 0, G_OPTION_ARG_INT, &log_lines, "Lines kept in the log view (0 = unlimited)", "N" },
+        { "cat2", '2', 0, G_OPTION_ARG_FILENAME, &cat2_device, "Standard COM port (CAT-2) used for PTT and keying", "DEVICE" },
+        { "cat2-baud", 0, 0, G_OPTION_ARG_INT, &cat2_baud, "CAT-2 baud rate (radio default 4800)", "BAUD" },
+        { "ptt", 0, 0, G_OPTION_ARG_STRING, &ptt_method, "PTT method: cat, rts or dtr", "METHOD" },
+        { "capture", 'w', 0, G_OPTION_ARG_FILENAME, &capture_path, "Record all port traffic with timestamps (appends)", "FILE" },
+        { "no-cache", 0, 0, G_OPTION_ARG_NONE, &no_cache, "Send every read to the radio, even when a fresh answer is known", NULL },
+        { "shm", 0, 0, G_OPTION_ARG_STRING, &shm_name, "Publish the radio state in shared memory (e.g. " RADIO_SHM_DEFAULT_NAME ")", "NAME" },
+        { NULL, 0, 0, 0, NULL, NULL, NULL }
+    };
+    GError *error = NULL;
+    if (!gtk_init_with_args(&argc, &argv, NULL, options, NULL, &error)) {
+        fprintf(stderr, "%s\n", error ? error->message : "Failed to initialise GTK");
+        g_clear_error(&error);
+        return 1;
+    }
+    if (log_lines < 0) {
+        log_lines = 0;
+    }
+
+    cat_ptt_method_t ptt = CAT_PTT_COMMAND;
+    if (ptt_method && g_ascii_strcasecmp(ptt_method, "rts") == 0) {
+        ptt = CAT_PTT_RTS;
+    } else if (ptt_method && g_ascii_strcasecmp(ptt_method, "dtr") == 0) {
+        ptt = CAT_PTT_DTR;
+    } else if (ptt_method && g_ascii_strcasecmp(ptt_method, "cat") != 0) {
+        fprintf(stderr, "Unknown PTT method '%s' (cat, rts or dtr)\n", ptt_method);
+        return 1;
+    }
 
     // Apply adaptive theme based on system settings
     apply_adaptive_theme();
 
     AppData app_data = {0};
+    app_data.fd = -1;
+    app_data.cat2_fd = -1;
+    app_data.cat2_device = cat2_device;
+    app_data.cat2_baudrate = cat2_baud;
+    app_data.ptt_method = ptt;
+    app_data.use_cache = !no_cache;
+    app_data.capture.fd = -1;
+    if (capture_path && cat_capture_open(&app_data.capture, capture_path) < 0) {
+        fprintf(stderr, "Cannot record to %s: %s\n", capture_path,
+                errno == EINVAL ? "not a capture file" : g_strerror(errno));
+        return 1;
+    }
+    if (shm_name && radio_shm_create(&app_data.shm, shm_name) < 0) {
+        fprintf(stderr, "Cannot publish under %s: %s\n", shm_name,
+                errno == EINVAL ? "the name must look like /name" : g_strerror(errno));
+        return 1;
+    }
     app_data.builder = gtk_builder_new();
     if (!gtk_builder_add_from_file(app_data.builder, "radio-ui.glade", NULL)) {
         fprintf(stderr, "Failed to load UI file\n");
@@ -411,15 +861,27 @@ int main(int argc, char *argv[]) {
     
    
 
+    app_data.frequency_label = GTK_WIDGET(gtk_builder_get_object(app_data.builder, "frame_label"));
+    if (!app_data.frequency_label) {
+        fprintf(stderr, "Failed to find frame_label widget\n");
+        return 1;
+    }
+
     app_data.bye_button = GTK_WIDGET(gtk_builder_get_object(app_data.builder, "bye_button"));
     if (!app_data.bye_button) {
         fprintf(stderr, "Failed to find bye_button widget\n");
         return 1;
     }
+
+    app_data.ptt_button = GTK_WIDGET(gtk_builder_get_object(app_data.builder, "ptt_button"));
+    if (!app_data.ptt_button) {
+        fprintf(stderr, "Failed to find ptt_button widget\n");
+        return 1;
+    }
     
    
     
-    app_data.response_buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(app_data.response_textview));
+    log_view_init(&app_data.log, app_data.response_textview, (guint)log_lines);
 
     gtk_window_set_title(GTK_WINDOW(app_data.main_window), "Radio CAT Control");
     gtk_window_set_default_size(GTK_WINDOW(app_data.main_window), 800, 600);
@@ -432,10 +894,21 @@ int main(int argc, char *argv[]) {
     g_signal_connect(app_data.send_button, "clicked", G_CALLBACK(on_send_command), &app_data);
     g_signal_connect(app_data.clear_button, "clicked", G_CALLBACK(on_clear_clicked), &app_data);
     g_signal_connect(app_data.bye_button, "clicked", G_CALLBACK(on_bye_clicked), &app_data);
+    g_signal_connect(app_data.ptt_button, "toggled", G_CALLBACK(on_ptt_toggled), &app_data);
 
     gtk_widget_show_all(app_data.main_window);
 
     gtk_main();
 
+    if (app_data.connected) {
+        close_port(&app_data);
+    }
+    log_view_free(&app_data.log);
+    cat_capture_close(&app_data.capture);
+    radio_shm_close(&app_data.shm);
+    g_free(capture_path);
+    g_free(shm_name);
+    g_free(cat2_device);
+    g_free(ptt_method);
     return 0;
 }
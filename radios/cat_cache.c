@@ -0,0 +1,172 @@
+#include "cat_cache.h"
+#include "cat_framer.h"
+#include <string.h>
+
+#define SLOT_BITS 6
+#define SLOT_MASK (CAT_CACHE_SLOTS - 1)
+
+_Static_assert(CAT_CACHE_SLOTS == 1 << SLOT_BITS, "SLOT_BITS must match CAT_CACHE_SLOTS");
+
+/* Knob-driven values go stale fastest; AI1 pushes refresh them for free anyway */
+static const struct {
+    char opcode[3];
+    uint32_t ttl_ms;
+} default_ttls[] = {
+    { "FA", 200 },
+    { "FB", 200 },
+    { "AG", 500 },
+    { "RG", 500 },
+    { "SQ", 500 },
+    { "MD", 1000 },
+    { "PC", 1000 },
+    { "GT", 1000 },
+    { "ST", 1000 },
+    { "CN", 1000 },
+    { "VE", CAT_CACHE_FOREVER },
+    { "RI", CAT_CACHE_FOREVER },
+};
+
+void cat_cache_init(cat_cache_t *cache) {
+    if (!cache) return;
+
+    memset(cache, 0, sizeof(*cache));
+    for (size_t i = 0; i < sizeof(default_ttls) / sizeof(default_ttls[0]); i++) {
+        cat_cache_set_ttl(cache, default_ttls[i].opcode, default_ttls[i].ttl_ms);
+    }
+}
+
+/* Freshness of one opcode, all VFOs. 0 stops caching it. */
+int cat_cache_set_ttl(cat_cache_t *cache, const char *opcode, uint32_t ttl_ms) {
+    if (!cache || !opcode || !opcode[0] || !opcode[1]) return -1;
+
+    uint16_t key = CAT_OPCODE(opcode[0], opcode[1]);
+    for (size_t i = 0; i < cache->ttl_count; i++) {
+        if (cache->ttls[i].opcode == key) {
+            cache->ttls[i].ttl_ms = ttl_ms;
+            return 0;
+        }
+    }
+    if (cache->ttl_count == CAT_CACHE_TTLS) return -1;
+
+    cache->ttls[cache->ttl_count++] = (cat_cache_ttl_t){ .opcode = key, .ttl_ms = ttl_ms };
+    return 0;
+}
+
+/* Forget every value (reconnect, or a command that may change several) */
+void cat_cache_clear(cat_cache_t *cache) {
+    if (!cache) return;
+
+    for (size_t i = 0; i < CAT_CACHE_SLOTS; i++) cache->slots[i].stamp_ns = 0;
+    cache->cleared_ns = cat_monotonic_ns();
+}
+
+static uint32_t ttl_of(const cat_cache_t *cache, uint32_t key) {
+    uint16_t opcode = (uint16_t)(key >> 8);
+
+    for (size_t i = 0; i < cache->ttl_count; i++) {
+        if (cache->ttls[i].opcode == opcode) return cache->ttls[i].ttl_ms;
+    }
+    return 0;
+}
+
+/* Open addressing with linear probing; a slot keeps its key for life, so
+ * invalidation only clears the stamp and no tombstones are needed */
+static cat_cache_entry_t *find_slot(cat_cache_t *cache, uint32_t key, bool create) {
+    size_t home = (size_t)((key * 2654435761u) >> (32 - SLOT_BITS));
+
+    for (size_t i = 0; i < CAT_CACHE_SLOTS; i++) {
+        cat_cache_entry_t *entry = &cache->slots[(home + i) & SLOT_MASK];
+        if (entry->key == key) return entry;
+        if (entry->key == 0) {
+            if (!create) return NULL;
+            entry->key = key;
+            return entry;
+        }
+    }
+    if (!create) return NULL;
+
+    /* Full: reuse the home slot, forgetting what it held */
+    cat_cache_entry_t *entry = &cache->slots[home];
+    entry->key = key;
+    entry->stamp_ns = 0;
+    entry->invalidated_ns = 0;
+    return entry;
+}
+
+/* Keep a received answer or AI push. Reads, "?;" and opcodes without a TTL are
+ * ignored. sent_ns is when the read it answers went out, 0 for AI pushes: an
+ * answer to a read sent before a set of the same value describes the radio
+ * before that set and is dropped. */
+void cat_cache_store(cat_cache_t *cache, const char *frame, size_t len, uint64_t rx_ns, uint64_t sent_ns) {
+    if (!cache || !frame || len > CAT_WIRE_MAX || cat_is_read_request(frame, len)) return;
+
+    uint32_t key = cat_request_key(frame, len);
+    if (key == 0 || ttl_of(cache, key) == 0) return;
+    if (sent_ns && sent_ns < cache->cleared_ns) return;
+
+    cat_response_t resp;
+    if (cat_dispatch_response(frame, len, &resp) != 0) return;
+
+    cat_cache_entry_t *entry = find_slot(cache, key, true);
+    if (sent_ns && sent_ns < entry->invalidated_ns) return;
+    entry->len = (uint8_t)len;
+    memcpy(entry->wire, frame, len);
+    entry->resp = resp;
+    entry->stamp_ns = rx_ns ? rx_ns : 1;
+}
+
+/* The fresh answer to a read request, or NULL if it has to go to the radio */
+const cat_cache_entry_t *cat_cache_lookup(cat_cache_t *cache, const char *frame, size_t len, uint64_t now_ns) {
+    if (!cache || !cat_is_read_request(frame, len)) return NULL;
+
+    uint32_t key = cat_request_key(frame, len);
+    uint32_t ttl_ms = key ? ttl_of(cache, key) : 0;
+    if (ttl_ms == 0) return NULL;
+
+    const cat_cache_entry_t *entry = find_slot(cache, key, false);
+    if (!entry || entry->stamp_ns == 0) return NULL;
+    if (ttl_ms != CAT_CACHE_FOREVER && now_ns - entry->stamp_ns >= (uint64_t)ttl_ms * 1000000ull) return NULL;
+
+    cache->hits++;
+    return entry;
+}
+
+static void invalidate_frame(cat_cache_t *cache, const char *frame, size_t len) {
+    if (cat_is_read_request(frame, len) || cat_command_class(frame, len) == CAT_CLASS_TX) return;
+
+    /* A set of one known value drops that value; the radio may clamp or refuse
+     * it, so the next read (or the AI echo) brings the real one. Anything else
+     * (band keys, A=B, opcodes we do not know) may touch several values. */
+    cat_response_t resp;
+    uint32_t key = cat_request_key(frame, len);
+    if (key && cat_dispatch_response(frame, len, &resp) == 0) {
+        if (ttl_of(cache, key) == 0) return;
+
+        /* The slot is kept even if empty: a read already in flight must not refill it */
+        cat_cache_entry_t *entry = find_slot(cache, key, true);
+        if (entry->stamp_ns) {
+            entry->stamp_ns = 0;
+            cache->invalidations++;
+        }
+        entry->invalidated_ns = cat_monotonic_ns();
+        return;
+    }
+    cat_cache_clear(cache);
+    cache->invalidations++;
+}
+
+/* Account for bytes sent to the radio, one or several frames; reads leave the cache alone */
+void cat_cache_invalidate(cat_cache_t *cache, const char *data, size_t len) {
+    if (!cache || !data) return;
+
+    size_t start = 0;
+    while (start < len) {
+        while (start < len && (data[start] == ' ' || data[start] == '\r' || data[start] == '\n')) start++;
+        if (start == len) break;
+
+        const char *semi = memchr(data + start, ';', len - start);
+        size_t end = semi ? (size_t)(semi - data) + 1 : len;
+        invalidate_frame(cache, data + start, end - start);
+        start = end;
+    }
+}
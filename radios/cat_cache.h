@@ -0,0 +1,47 @@
+#ifndef CAT_CACHE_H
+#define CAT_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ftx1_cat.h"
+
+#define CAT_CACHE_SLOTS     64          /* Power of two, well above opcodes x VFOs */
+#define CAT_CACHE_TTLS      16
+#define CAT_CACHE_FOREVER   UINT32_MAX  /* TTL of values that never change (firmware, model) */
+
+/* Latest value of one opcode + VFO, as received and decoded */
+typedef struct {
+    uint32_t key;               /* cat_request_key(), 0 if the slot was never used */
+    uint8_t len;
+    char wire[CAT_WIRE_MAX];
+    cat_response_t resp;
+    uint64_t stamp_ns;          /* Receive time, 0 once invalidated */
+    uint64_t invalidated_ns;    /* Last set sent for this key: answers to older reads are stale */
+} cat_cache_entry_t;
+
+typedef struct {
+    uint16_t opcode;            /* CAT_OPCODE() */
+    uint32_t ttl_ms;            /* 0: never cached */
+} cat_cache_ttl_t;
+
+/* Answers reads locally while the last answer or AI push for the same
+ * opcode + VFO is younger than that opcode's TTL */
+typedef struct {
+    cat_cache_entry_t slots[CAT_CACHE_SLOTS];
+    cat_cache_ttl_t ttls[CAT_CACHE_TTLS];
+    size_t ttl_count;
+    uint64_t cleared_ns;        /* Last clear: answers to reads sent before it are stale */
+    uint64_t hits;              /* Reads answered without touching the link */
+    uint64_t invalidations;     /* Values dropped by sets we sent */
+} cat_cache_t;
+
+/* Function Prototypes */
+void cat_cache_init(cat_cache_t *cache);
+int cat_cache_set_ttl(cat_cache_t *cache, const char *opcode, uint32_t ttl_ms);
+void cat_cache_clear(cat_cache_t *cache);
+void cat_cache_store(cat_cache_t *cache, const char *frame, size_t len, uint64_t rx_ns, uint64_t sent_ns);
+const cat_cache_entry_t *cat_cache_lookup(cat_cache_t *cache, const char *frame, size_t len, uint64_t now_ns);
+void cat_cache_invalidate(cat_cache_t *cache, const char *data, size_t len);
+
+#endif /* CAT_CACHE_H */
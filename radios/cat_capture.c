@@ -0,0 +1,174 @@
+#include "cat_capture.h"
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define PAD8(n) (((n) + 7u) & ~(size_t)7u)
+#define MAX_IOV 8
+
+static int open_failed(cat_capture_t *cap, int err) {
+    close(cap->fd);
+    cap->fd = -1;
+    errno = err;
+    return -1;
+}
+
+/* Create the file with its magic, or append to an existing capture */
+int cat_capture_open(cat_capture_t *cap, const char *path) {
+    if (!cap || !path) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    cap->fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (cap->fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(cap->fd, &st) < 0) return open_failed(cap, errno);
+
+    if (st.st_size == 0) {
+        if (write(cap->fd, CAT_CAPTURE_MAGIC, CAT_CAPTURE_MAGIC_LEN) != CAT_CAPTURE_MAGIC_LEN) {
+            return open_failed(cap, errno ? errno : EIO);
+        }
+        return 0;
+    }
+
+    /* Only append after our own header, never to some other file */
+    int rfd = open(path, O_RDONLY | O_CLOEXEC);
+    if (rfd < 0) return open_failed(cap, errno);
+    bool ours = cat_capture_is_capture(rfd);
+    close(rfd);
+    if (!ours || st.st_size % 8 != 0) return open_failed(cap, EINVAL);
+    return 0;
+}
+
+/* One record from a gather list: header, data, padding in a single writev() */
+int cat_capture_writev(cat_capture_t *cap, cat_capture_dir_t dir, uint16_t port, uint64_t t_ns,
+                       const struct iovec *iov, int iovcnt) {
+    static const char zeros[8];
+
+    if (!cap || cap->fd < 0 || iovcnt < 0 || iovcnt > MAX_IOV) return -1;
+
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) len += iov[i].iov_len;
+    if (len == 0) return 0;
+    if (len > CAT_CAPTURE_MAX_CHUNK) return -1;
+
+    cat_capture_record_t rec = {
+        .t_ns = t_ns,
+        .len = (uint32_t)len,
+        .dir = (uint16_t)dir,
+        .port = port,
+    };
+
+    struct iovec out[MAX_IOV + 2];
+    int n = 0;
+    out[n++] = (struct iovec){ .iov_base = &rec, .iov_len = sizeof(rec) };
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len) out[n++] = iov[i];
+    }
+    if (PAD8(len) != len) {
+        out[n++] = (struct iovec){ .iov_base = (void *)zeros, .iov_len = PAD8(len) - len };
+    }
+
+    ssize_t total = (ssize_t)(sizeof(rec) + PAD8(len));
+    ssize_t written;
+    do {
+        written = writev(cap->fd, out, n);
+    } while (written < 0 && errno == EINTR);
+    return written == total ? 0 : -1;
+}
+
+int cat_capture_write(cat_capture_t *cap, cat_capture_dir_t dir, uint16_t port, uint64_t t_ns,
+                      const void *data, size_t len) {
+    struct iovec iov = { .iov_base = (void *)data, .iov_len = len };
+    return cat_capture_writev(cap, dir, port, t_ns, &iov, 1);
+}
+
+void cat_capture_close(cat_capture_t *cap) {
+    if (!cap || cap->fd < 0) return;
+
+    close(cap->fd);
+    cap->fd = -1;
+}
+
+/* True if fd starts with the capture magic; the file offset is left where it was */
+bool cat_capture_is_capture(int fd) {
+    char magic[CAT_CAPTURE_MAGIC_LEN];
+
+    return pread(fd, magic, sizeof(magic), 0) == (ssize_t)sizeof(magic) &&
+           memcmp(magic, CAT_CAPTURE_MAGIC, sizeof(magic)) == 0;
+}
+
+int cat_capture_map(cat_capture_reader_t *reader, const char *path) {
+    if (!reader || !path) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(reader, 0, sizeof(*reader));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    if (!cat_capture_is_capture(fd)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    /* The whole file is walked front to back, usually once */
+    madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    reader->base = base;
+    reader->size = (size_t)st.st_size;
+    reader->offset = CAT_CAPTURE_MAGIC_LEN;
+    return 0;
+}
+
+/* Next record: 1 with rec and data (pointing into the mapping) set, 0 at the end, -1 if corrupt */
+int cat_capture_next(cat_capture_reader_t *reader, cat_capture_record_t *rec, const char **data) {
+    if (!reader || !reader->base || !rec || !data) return -1;
+
+    size_t left = reader->size - reader->offset;
+    if (left == 0) return 0;
+    if (left < sizeof(*rec)) {
+        reader->truncated = true;
+        return 0;
+    }
+
+    memcpy(rec, reader->base + reader->offset, sizeof(*rec));
+    if (rec->len > CAT_CAPTURE_MAX_CHUNK || rec->dir > CAT_CAPTURE_TX) return -1;
+
+    size_t span = sizeof(*rec) + PAD8((size_t)rec->len);
+    if (span > left) {
+        reader->truncated = true;
+        return 0;
+    }
+
+    *data = (const char *)reader->base + reader->offset + sizeof(*rec);
+    reader->offset += span;
+    return 1;
+}
+
+void cat_capture_rewind(cat_capture_reader_t *reader) {
+    if (reader) reader->offset = CAT_CAPTURE_MAGIC_LEN;
+}
+
+void cat_capture_unmap(cat_capture_reader_t *reader) {
+    if (!reader || !reader->base) return;
+
+    munmap((void *)reader->base, reader->size);
+    memset(reader, 0, sizeof(*reader));
+}
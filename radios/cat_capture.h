@@ -0,0 +1,63 @@
+#ifndef CAT_CAPTURE_H
+#define CAT_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/uio.h>
+
+/* On-disk layout, host byte order (little-endian on every supported target):
+ *
+ *   file    = header record*
+ *   header  = "CATCAP1\n" (8 bytes)
+ *   record  = cat_capture_record_t, then len bytes of data, zero-padded to 8
+ *
+ * Records are only ever appended, each with a single writev(), so a capture
+ * that is still being written can be read up to its last complete record.
+ * Every header is 8-byte aligned, so a reader can walk an mmap() of the file
+ * without copying. */
+#define CAT_CAPTURE_MAGIC      "CATCAP1\n"
+#define CAT_CAPTURE_MAGIC_LEN  8
+#define CAT_CAPTURE_MAX_CHUNK  (1u << 20)   /* Longer records are taken as corruption */
+
+typedef enum {
+    CAT_CAPTURE_RX = 0,     /* Bytes read from the radio */
+    CAT_CAPTURE_TX = 1      /* Bytes queued for the radio */
+} cat_capture_dir_t;
+
+typedef struct {
+    uint64_t t_ns;          /* CLOCK_MONOTONIC: the read() for RX, the queueing for TX */
+    uint32_t len;           /* Data bytes following the header, padding excluded */
+    uint16_t dir;           /* cat_capture_dir_t */
+    uint16_t port;          /* Port the chunk belongs to (engine port id, CAT-1/CAT-2) */
+} cat_capture_record_t;
+
+/* Append side. Writes from several threads are safe: each record is one
+ * O_APPEND writev() of a regular file. */
+typedef struct {
+    int fd;
+} cat_capture_t;
+
+/* Read side over a read-only mapping of the whole file */
+typedef struct {
+    const uint8_t *base;
+    size_t size;
+    size_t offset;          /* Next record header */
+    bool truncated;         /* The last record was cut short (capture still growing or crashed) */
+} cat_capture_reader_t;
+
+/* Function Prototypes */
+int cat_capture_open(cat_capture_t *cap, const char *path);
+int cat_capture_write(cat_capture_t *cap, cat_capture_dir_t dir, uint16_t port, uint64_t t_ns,
+                      const void *data, size_t len);
+int cat_capture_writev(cat_capture_t *cap, cat_capture_dir_t dir, uint16_t port, uint64_t t_ns,
+                       const struct iovec *iov, int iovcnt);
+void cat_capture_close(cat_capture_t *cap);
+
+int cat_capture_map(cat_capture_reader_t *reader, const char *path);
+int cat_capture_next(cat_capture_reader_t *reader, cat_capture_record_t *rec, const char **data);
+void cat_capture_rewind(cat_capture_reader_t *reader);
+void cat_capture_unmap(cat_capture_reader_t *reader);
+bool cat_capture_is_capture(int fd);
+
+#endif /* CAT_CAPTURE_H */
@@ -0,0 +1,180 @@
+#include "cat_framer.h"
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+#define RING_MASK (CAT_FRAMER_RING_SIZE - 1)
+
+uint64_t cat_monotonic_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void cat_framer_reset(cat_framer_t *framer) {
+    if (!framer) return;
+
+    framer->head = 0;
+    framer->tail = 0;
+    framer->scan = 0;
+    framer->batch_count = 0;
+    framer->frames = 0;
+    framer->dropped = 0;
+    framer->stamp_ns = 0;
+    framer->tap = NULL;
+    framer->tap_data = NULL;
+}
+
+size_t cat_framer_pending(const cat_framer_t *framer) {
+    return framer ? framer->head - framer->tail : 0;
+}
+
+/* Contiguous free space at the write position, so read() can land directly in the ring */
+size_t cat_framer_write_space(cat_framer_t *framer, char **dst) {
+    size_t free_bytes = CAT_FRAMER_RING_SIZE - (framer->head - framer->tail);
+    size_t to_end = CAT_FRAMER_RING_SIZE - (framer->head & RING_MASK);
+
+    *dst = framer->ring + (framer->head & RING_MASK);
+    return free_bytes < to_end ? free_bytes : to_end;
+}
+
+static void flush_batch(cat_framer_t *framer, cat_frame_batch_cb cb, void *user_data) {
+    if (framer->batch_count == 0) return;
+
+    if (cb) cb(framer->batch, framer->batch_count, user_data);
+    framer->frames += framer->batch_count;
+    framer->batch_count = 0;
+}
+
+static void emit_frame(cat_framer_t *framer, size_t end, cat_frame_batch_cb cb, void *user_data) {
+    /* Skip line noise left between frames (the terminals append '\n' after commands) */
+    while (framer->tail < end) {
+        char c = framer->ring[framer->tail & RING_MASK];
+        if (c != '\r' && c != '\n' && c != ' ' && c != '\0') break;
+        framer->tail++;
+    }
+
+    size_t len = end - framer->tail + 1;
+    if (len == 1) {
+        framer->tail = end + 1;   /* Bare ';' */
+        return;
+    }
+    if (len > CAT_FRAMER_MAX_FRAME) {
+        framer->dropped += len;
+        framer->tail = end + 1;
+        return;
+    }
+
+    size_t start = framer->tail & RING_MASK;
+    if (start + len > CAT_FRAMER_RING_SIZE) {
+        /* Frame wraps: mirror its head part after the ring end */
+        memcpy(framer->ring + CAT_FRAMER_RING_SIZE, framer->ring,
+               start + len - CAT_FRAMER_RING_SIZE);
+    }
+
+    framer->batch[framer->batch_count].data = framer->ring + start;
+    framer->batch[framer->batch_count].len = len;
+    framer->batch[framer->batch_count].rx_ns = framer->stamp_ns;
+    framer->tail = end + 1;
+
+    if (++framer->batch_count == CAT_FRAMER_BATCH) {
+        flush_batch(framer, cb, user_data);
+    }
+}
+
+void cat_framer_commit(cat_framer_t *framer, size_t len, cat_frame_batch_cb cb, void *user_data) {
+    if (!framer) return;
+
+    framer->head += len;
+
+    while (framer->scan < framer->head) {
+        size_t offset = framer->scan & RING_MASK;
+        size_t chunk = framer->head - framer->scan;
+        if (chunk > CAT_FRAMER_RING_SIZE - offset) {
+            chunk = CAT_FRAMER_RING_SIZE - offset;
+        }
+
+        const char *hit = memchr(framer->ring + offset, CAT_FRAME_TERMINATOR, chunk);
+        if (!hit) {
+            framer->scan += chunk;
+            continue;
+        }
+
+        size_t end = framer->scan + (size_t)(hit - (framer->ring + offset));
+        emit_frame(framer, end, cb, user_data);
+        framer->scan = end + 1;
+    }
+
+    /* A partial frame that can no longer fit is garbage, resynchronise on the next ';' */
+    if (framer->head - framer->tail > CAT_FRAMER_MAX_FRAME) {
+        framer->dropped += framer->head - framer->tail;
+        framer->tail = framer->head;
+    }
+
+    flush_batch(framer, cb, user_data);
+}
+
+void cat_framer_set_tap(cat_framer_t *framer, cat_framer_tap_fn tap, void *tap_data) {
+    if (!framer) return;
+
+    framer->tap = tap;
+    framer->tap_data = tap_data;
+}
+
+/* Copying entry point for data that does not come from a file descriptor */
+size_t cat_framer_push(cat_framer_t *framer, const char *data, size_t len,
+                       cat_frame_batch_cb cb, void *user_data) {
+    return cat_framer_push_at(framer, data, len, cat_monotonic_ns(), cb, user_data);
+}
+
+/* Same, with the receive time given by the caller (replaying a capture) */
+size_t cat_framer_push_at(cat_framer_t *framer, const char *data, size_t len, uint64_t rx_ns,
+                          cat_frame_batch_cb cb, void *user_data) {
+    if (!framer || !data) return 0;
+
+    framer->stamp_ns = rx_ns;
+    if (framer->tap) framer->tap(data, len, rx_ns, framer->tap_data);
+
+    size_t done = 0;
+    while (done < len) {
+        char *dst;
+        size_t space = cat_framer_write_space(framer, &dst);
+        size_t n = len - done < space ? len - done : space;
+
+        memcpy(dst, data + done, n);
+        cat_framer_commit(framer, n, cb, user_data);
+        done += n;
+    }
+    return done;
+}
+
+/* Drain a non-blocking fd straight into the ring. Returns bytes read, or -1 with errno set. */
+ssize_t cat_framer_read_fd(cat_framer_t *framer, int fd, cat_frame_batch_cb cb, void *user_data) {
+    if (!framer) return -1;
+
+    ssize_t total = 0;
+    for (;;) {
+        char *dst;
+        size_t space = cat_framer_write_space(framer, &dst);
+        ssize_t n = read(fd, dst, space);
+
+        if (n > 0) {
+            framer->stamp_ns = cat_monotonic_ns();
+            if (framer->tap) framer->tap(dst, (size_t)n, framer->stamp_ns, framer->tap_data);
+            cat_framer_commit(framer, (size_t)n, cb, user_data);
+            total += n;
+            if ((size_t)n < space) break;   /* Short read: driver queue is empty */
+        } else if (n == 0) {
+            break;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            return total > 0 ? total : -1;
+        }
+    }
+    return total;
+}
@@ -0,0 +1,55 @@
+#ifndef CAT_FRAMER_H
+#define CAT_FRAMER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* Ring size must be a power of two */
+#define CAT_FRAMER_RING_SIZE  4096
+#define CAT_FRAMER_MAX_FRAME  128   /* Longest frame accepted, ';' included */
+#define CAT_FRAMER_BATCH      64    /* Frames handed to the callback at once */
+#define CAT_FRAME_TERMINATOR  ';'
+
+/* Complete frame: a slice into the framer ring, valid only during the callback.
+ * The terminating ';' is included in len, the data is NOT null-terminated. */
+typedef struct {
+    const char *data;
+    size_t len;
+    uint64_t rx_ns;     /* CLOCK_MONOTONIC time of the read() that completed the frame */
+} cat_frame_t;
+
+typedef void (*cat_frame_batch_cb)(const cat_frame_t *frames, size_t count, void *user_data);
+/* Raw bytes of one read(), before framing, e.g. for a capture */
+typedef void (*cat_framer_tap_fn)(const char *data, size_t len, uint64_t rx_ns, void *user_data);
+
+/* Incremental ';' framer over a byte ring */
+typedef struct {
+    /* Ring storage plus a mirror tail so a frame wrapping the end stays contiguous */
+    char ring[CAT_FRAMER_RING_SIZE + CAT_FRAMER_MAX_FRAME];
+    size_t head;        /* Next byte to write (monotonic) */
+    size_t tail;        /* Start of the pending (incomplete) frame (monotonic) */
+    size_t scan;        /* Next byte to inspect for a terminator (monotonic) */
+    cat_frame_t batch[CAT_FRAMER_BATCH];
+    size_t batch_count;
+    uint64_t frames;    /* Frames dispatched */
+    uint64_t dropped;   /* Bytes discarded as oversize garbage */
+    uint64_t stamp_ns;  /* Receive time applied to frames completed by the current commit */
+    cat_framer_tap_fn tap;  /* Optional, cleared by cat_framer_reset() */
+    void *tap_data;
+} cat_framer_t;
+
+/* Function Prototypes */
+uint64_t cat_monotonic_ns(void);
+void cat_framer_reset(cat_framer_t *framer);
+size_t cat_framer_write_space(cat_framer_t *framer, char **dst);
+void cat_framer_commit(cat_framer_t *framer, size_t len, cat_frame_batch_cb cb, void *user_data);
+size_t cat_framer_push(cat_framer_t *framer, const char *data, size_t len,
+                       cat_frame_batch_cb cb, void *user_data);
+size_t cat_framer_push_at(cat_framer_t *framer, const char *data, size_t len, uint64_t rx_ns,
+                          cat_frame_batch_cb cb, void *user_data);
+void cat_framer_set_tap(cat_framer_t *framer, cat_framer_tap_fn tap, void *tap_data);
+ssize_t cat_framer_read_fd(cat_framer_t *framer, int fd, cat_frame_batch_cb cb, void *user_data);
+size_t cat_framer_pending(const cat_framer_t *framer);
+
+#endif /* CAT_FRAMER_H */
@@ -0,0 +1,330 @@
+#include "cat_pipeline.h"
+#include "cat_framer.h"
+#include <string.h>
+
+#define BACKLOG_MASK (CAT_PIPELINE_BACKLOG - 1)
+#define SETS_MASK (CAT_PIPELINE_SETS - 1)
+
+void cat_pipeline_init(cat_pipeline_t *pipe, size_t depth, cat_pipeline_write_fn write, void *io_data) {
+    if (!pipe) return;
+
+    memset(pipe, 0, sizeof(*pipe));
+    if (depth == 0) depth = 1;
+    if (depth > CAT_PIPELINE_MAX_DEPTH) depth = CAT_PIPELINE_MAX_DEPTH;
+    pipe->depth = depth;
+    pipe->timeout_ns = CAT_PIPELINE_TIMEOUT_NS;
+    pipe->max_timeout_ns = CAT_PIPELINE_MAX_TIMEOUT_NS;
+    pipe->max_retries = CAT_PIPELINE_RETRIES;
+    pipe->write = write;
+    pipe->io_data = io_data;
+}
+
+/* Every received frame refreshes the cache, and reads it holds a fresh answer
+ * for complete on the next pump without being sent. Sets queued here are
+ * dropped from it when written; whoever sends sets around the pipeline calls
+ * cat_cache_invalidate(). NULL turns caching off. */
+void cat_pipeline_set_cache(cat_pipeline_t *pipe, cat_cache_t *cache) {
+    if (pipe) pipe->cache = cache;
+}
+
+/* A read unanswered by its deadline is sent again up to max_retries times,
+ * each wait twice the previous one but never above max_timeout_ns. */
+void cat_pipeline_set_deadline(cat_pipeline_t *pipe, uint64_t timeout_ns, unsigned max_retries,
+                               uint64_t max_timeout_ns) {
+    if (!pipe || timeout_ns == 0) return;
+
+    pipe->timeout_ns = timeout_ns;
+    pipe->max_retries = max_retries;
+    pipe->max_timeout_ns = max_timeout_ns > timeout_ns ? max_timeout_ns : timeout_ns;
+}
+
+/* Queue a read. Sets and unknown opcodes get no answer and are refused. */
+int cat_pipeline_submit_frame(cat_pipeline_t *pipe, const char *frame, size_t len,
+                              cat_request_cb cb, void *user_data) {
+    if (!pipe || !frame || len == 0 || len > CAT_WIRE_MAX) return -1;
+    if (!cat_is_read_request(frame, len)) return -1;
+    if (pipe->backlog_head - pipe->backlog_tail == CAT_PIPELINE_BACKLOG) return -1;
+
+    cat_request_t *req = &pipe->backlog[pipe->backlog_head & BACKLOG_MASK];
+    memcpy(req->wire, frame, len);
+    req->len = (uint8_t)len;
+    if (req->wire[len - 1] != ';') {
+        if (len == CAT_WIRE_MAX) return -1;
+        req->wire[req->len++] = ';';
+    }
+    req->key = cat_request_key(req->wire, req->len);
+    req->tx_ns = 0;
+    req->deadline_ns = 0;
+    req->attempts = 0;
+    req->set = false;
+    req->cb = cb;
+    req->user_data = user_data;
+
+    pipe->backlog_head++;
+    return 0;
+}
+
+/* Queue a set behind the reads already waiting, so it cannot overtake them on
+ * the wire. It takes no window slot: pump writes it in turn, drops what it
+ * changes from the cache and notes it as cat_pipeline_note_set() would, with cb. */
+int cat_pipeline_submit_set(cat_pipeline_t *pipe, const char *frame, size_t len,
+                            cat_request_cb cb, void *user_data) {
+    if (!pipe || !frame || len == 0 || len > CAT_WIRE_MAX) return -1;
+    if (cat_is_read_request(frame, len)) return -1;
+    if (pipe->backlog_head - pipe->backlog_tail == CAT_PIPELINE_BACKLOG) return -1;
+
+    cat_request_t *req = &pipe->backlog[pipe->backlog_head & BACKLOG_MASK];
+    memset(req, 0, sizeof(*req));
+    memcpy(req->wire, frame, len);
+    req->len = (uint8_t)len;
+    req->set = true;
+    req->cb = cb;
+    req->user_data = user_data;
+
+    pipe->backlog_head++;
+    return 0;
+}
+
+/* Complete the oldest set mark; it is copied out first, the callback may note another */
+static void finish_set(cat_pipeline_t *pipe, cat_request_status_t status, const char *frame, size_t len,
+                       uint64_t now_ns) {
+    cat_set_mark_t mark = pipe->sets[pipe->sets_tail++ & SETS_MASK];
+    uint64_t rtt = now_ns > mark.tx_ns ? now_ns - mark.tx_ns : 0;
+
+    if (mark.cb) mark.cb(status, NULL, frame, len, rtt, mark.user_data);
+}
+
+/* Call right after handing a set (anything but a pipeline read) to the same
+ * transport, so a "?;" can be told apart from a rejected read. cb, if any,
+ * completes with CAT_REQUEST_REJECTED and the "?;", or CAT_REQUEST_OK and no
+ * frame once the radio has visibly moved past it. Marks and reads are ordered
+ * by when they reach the transport, not by when they were submitted. */
+void cat_pipeline_note_set(cat_pipeline_t *pipe, cat_request_cb cb, void *user_data) {
+    if (!pipe) return;
+
+    uint64_t now = cat_monotonic_ns();
+    if (pipe->sets_head - pipe->sets_tail == CAT_PIPELINE_SETS) finish_set(pipe, CAT_REQUEST_OK, NULL, 0, now);
+
+    pipe->sets[pipe->sets_head++ & SETS_MASK] = (cat_set_mark_t){
+        .seq = ++pipe->send_seq,
+        .tx_ns = now,
+        .deadline_ns = now + pipe->timeout_ns,
+        .cb = cb,
+        .user_data = user_data,
+    };
+}
+
+int cat_pipeline_submit(cat_pipeline_t *pipe, const cat_command_t *cmd, cat_request_cb cb, void *user_data) {
+    char wire[CAT_WIRE_MAX];
+    int len = cat_encode_command(cmd, wire, sizeof(wire));
+    if (len < 0) return -1;
+    return cat_pipeline_submit_frame(pipe, wire, (size_t)len, cb, user_data);
+}
+
+/* Complete the oldest backlog request with a cached value. Both are copied out
+ * first: the callback may submit again or feed the cache. */
+static void answer_from_cache(cat_pipeline_t *pipe, const cat_cache_entry_t *entry) {
+    cat_cache_entry_t value = *entry;
+    cat_request_t req = pipe->backlog[pipe->backlog_tail++ & BACKLOG_MASK];
+
+    pipe->completed++;
+    if (req.cb) req.cb(CAT_REQUEST_OK, &value.resp, value.wire, value.len, 0, req.user_data);
+}
+
+/* Fill the window from the backlog in order, answering what the cache holds and
+ * writing queued sets on the way.
+ * Returns the number of frames handed to the transport; the caller flushes
+ * once afterwards so they share one write. */
+size_t cat_pipeline_pump(cat_pipeline_t *pipe) {
+    if (!pipe || !pipe->write) return 0;
+
+    size_t sent = 0;
+    while (pipe->backlog_tail != pipe->backlog_head) {
+        cat_request_t *req = &pipe->backlog[pipe->backlog_tail & BACKLOG_MASK];
+        if (req->set) {
+            if (pipe->write(req->wire, req->len, pipe->io_data) != 0) break;
+
+            cat_request_t set = *req;
+            pipe->backlog_tail++;
+            if (pipe->cache) cat_cache_invalidate(pipe->cache, set.wire, set.len);
+            cat_pipeline_note_set(pipe, set.cb, set.user_data);
+            sent++;
+            continue;
+        }
+
+        const cat_cache_entry_t *cached = pipe->cache ?
+            cat_cache_lookup(pipe->cache, req->wire, req->len, cat_monotonic_ns()) : NULL;
+        if (cached) {
+            answer_from_cache(pipe, cached);
+            continue;
+        }
+
+        if (pipe->inflight_count >= pipe->depth) break;
+        if (pipe->write(req->wire, req->len, pipe->io_data) != 0) break;
+
+        req->tx_ns = cat_monotonic_ns();
+        req->deadline_ns = req->tx_ns + pipe->timeout_ns;
+        req->attempts = 1;
+        req->seq = ++pipe->send_seq;
+        pipe->inflight[pipe->inflight_count++] = *req;
+        pipe->backlog_tail++;
+        sent++;
+    }
+    return sent;
+}
+
+static void complete(cat_pipeline_t *pipe, size_t index, cat_request_status_t status,
+                     const char *frame, size_t len, uint64_t now_ns) {
+    cat_request_t req = pipe->inflight[index];
+
+    memmove(&pipe->inflight[index], &pipe->inflight[index + 1],
+            (pipe->inflight_count - index - 1) * sizeof(pipe->inflight[0]));
+    pipe->inflight_count--;
+
+    if (status == CAT_REQUEST_OK) pipe->completed++;
+    else pipe->failed++;
+
+    if (!req.cb) return;
+
+    cat_response_t resp;
+    const cat_response_t *decoded = NULL;
+    if (status == CAT_REQUEST_OK && cat_dispatch_response(frame, len, &resp) == 0) {
+        decoded = &resp;
+    }
+    uint64_t rtt = now_ns > req.tx_ns ? now_ns - req.tx_ns : 0;
+    req.cb(status, decoded, frame, len, rtt, req.user_data);
+}
+
+/* In-flight read sent first (a retry moves a read to the back), inflight_count if none */
+static size_t oldest_read(const cat_pipeline_t *pipe) {
+    size_t oldest = pipe->inflight_count;
+
+    for (size_t i = 0; i < pipe->inflight_count; i++) {
+        if (oldest == pipe->inflight_count || pipe->inflight[i].seq < pipe->inflight[oldest].seq) oldest = i;
+    }
+    return oldest;
+}
+
+/* Offer a received frame. Returns true if it answered an in-flight request or
+ * rejected a noted set; false for unsolicited traffic (AI pushes), which the
+ * caller handles as usual. */
+bool cat_pipeline_on_frame(cat_pipeline_t *pipe, const char *frame, size_t len, uint64_t rx_ns) {
+    if (!pipe || !frame) return false;
+
+    /* The cache needs to know when the read this answers went out (0: an AI push) */
+    uint32_t key = cat_request_key(frame, len);
+    if (pipe->cache) {
+        uint64_t sent_ns = 0;
+        for (size_t i = 0; key && i < pipe->inflight_count && !sent_ns; i++) {
+            if (pipe->inflight[i].key == key) sent_ns = pipe->inflight[i].tx_ns;
+        }
+        cat_cache_store(pipe->cache, frame, len, rx_ns, sent_ns);
+    }
+
+    /* The radio answers in order, so "?;" belongs to the oldest send not yet
+     * accounted for, set or read */
+    if (len >= 1 && frame[0] == '?') {
+        size_t oldest = oldest_read(pipe);
+        bool has_set = pipe->sets_head != pipe->sets_tail;
+
+        if (has_set && (oldest == pipe->inflight_count ||
+                        pipe->sets[pipe->sets_tail & SETS_MASK].seq < pipe->inflight[oldest].seq)) {
+            finish_set(pipe, CAT_REQUEST_REJECTED, frame, len, rx_ns);
+            return true;
+        }
+        if (oldest == pipe->inflight_count) return false;
+        complete(pipe, oldest, CAT_REQUEST_REJECTED, frame, len, rx_ns);
+        return true;
+    }
+
+    if (key == 0) return false;
+
+    for (size_t i = 0; i < pipe->inflight_count; i++) {
+        if (pipe->inflight[i].key == key) {
+            /* Every set sent before this read went through without a "?;" */
+            uint64_t seq = pipe->inflight[i].seq;
+            while (pipe->sets_head != pipe->sets_tail && pipe->sets[pipe->sets_tail & SETS_MASK].seq < seq) {
+                finish_set(pipe, CAT_REQUEST_OK, NULL, 0, rx_ns);
+            }
+            complete(pipe, i, CAT_REQUEST_OK, frame, len, rx_ns);
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t retry_timeout(const cat_pipeline_t *pipe, unsigned attempts) {
+    uint64_t timeout = pipe->timeout_ns;
+    while (attempts-- > 1 && timeout < pipe->max_timeout_ns) timeout *= 2;
+    return timeout < pipe->max_timeout_ns ? timeout : pipe->max_timeout_ns;
+}
+
+/* Act on every deadline that has passed: send the read again or fail it.
+ * Returns the number of requests re-sent or failed; after re-sends the caller
+ * flushes the transport, and after failures a pump can fill the freed slots. */
+size_t cat_pipeline_expire(cat_pipeline_t *pipe, uint64_t now_ns) {
+    if (!pipe) return 0;
+
+    /* No "?;" by now: the radio took the set */
+    size_t handled = 0;
+    while (pipe->sets_head != pipe->sets_tail && now_ns >= pipe->sets[pipe->sets_tail & SETS_MASK].deadline_ns) {
+        finish_set(pipe, CAT_REQUEST_OK, NULL, 0, now_ns);
+        handled++;
+    }
+
+    size_t i = 0;
+    while (i < pipe->inflight_count) {
+        cat_request_t *req = &pipe->inflight[i];
+        if (now_ns < req->deadline_ns) {
+            i++;
+            continue;
+        }
+
+        handled++;
+        if (req->attempts <= pipe->max_retries &&
+            pipe->write(req->wire, req->len, pipe->io_data) == 0) {
+            req->attempts++;
+            req->seq = ++pipe->send_seq;
+            req->deadline_ns = now_ns + retry_timeout(pipe, req->attempts);
+            pipe->retries++;
+            i++;
+        } else {
+            complete(pipe, i, CAT_REQUEST_TIMEOUT, NULL, 0, now_ns);
+        }
+    }
+    return handled;
+}
+
+/* Earliest deadline in flight, 0 if nothing waits: one timer serves every request */
+uint64_t cat_pipeline_next_deadline(const cat_pipeline_t *pipe) {
+    if (!pipe) return 0;
+
+    uint64_t next = pipe->sets_head != pipe->sets_tail ? pipe->sets[pipe->sets_tail & SETS_MASK].deadline_ns : 0;
+    for (size_t i = 0; i < pipe->inflight_count; i++) {
+        if (next == 0 || pipe->inflight[i].deadline_ns < next) next = pipe->inflight[i].deadline_ns;
+    }
+    return next;
+}
+
+/* Drop everything, completing each request and set mark with CAT_REQUEST_CANCELLED */
+void cat_pipeline_cancel(cat_pipeline_t *pipe) {
+    if (!pipe) return;
+
+    uint64_t now = cat_monotonic_ns();
+    while (pipe->inflight_count) {
+        complete(pipe, 0, CAT_REQUEST_CANCELLED, NULL, 0, now);
+    }
+    while (pipe->backlog_tail != pipe->backlog_head) {
+        cat_request_t req = pipe->backlog[pipe->backlog_tail++ & BACKLOG_MASK];
+        pipe->failed++;
+        if (req.cb) req.cb(CAT_REQUEST_CANCELLED, NULL, NULL, 0, 0, req.user_data);
+    }
+    while (pipe->sets_head != pipe->sets_tail) {
+        finish_set(pipe, CAT_REQUEST_CANCELLED, NULL, 0, now);
+    }
+}
+
+/* Reads and sets queued, reads in flight; set marks are not counted */
+size_t cat_pipeline_pending(const cat_pipeline_t *pipe) {
+    return pipe ? pipe->inflight_count + (pipe->backlog_head - pipe->backlog_tail) : 0;
+}
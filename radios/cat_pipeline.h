@@ -0,0 +1,98 @@
+#ifndef CAT_PIPELINE_H
+#define CAT_PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ftx1_cat.h"
+#include "cat_cache.h"
+
+#define CAT_PIPELINE_MAX_DEPTH      16  /* Upper bound for K */
+#define CAT_PIPELINE_DEFAULT_DEPTH  8
+#define CAT_PIPELINE_BACKLOG        64  /* Requests waiting for a window slot (power of two) */
+#define CAT_PIPELINE_SETS           64  /* Sets that may still draw a "?;" (power of two) */
+#define CAT_PIPELINE_TIMEOUT_NS     300000000ull    /* First deadline after a send */
+#define CAT_PIPELINE_MAX_TIMEOUT_NS 2000000000ull   /* Backoff cap for retries */
+#define CAT_PIPELINE_RETRIES        2
+
+typedef enum {
+    CAT_REQUEST_OK,             /* Answer received and decoded into resp */
+    CAT_REQUEST_REJECTED,       /* Radio answered "?;" */
+    CAT_REQUEST_TIMEOUT,        /* No answer before the last deadline, retries included */
+    CAT_REQUEST_CANCELLED       /* Pipeline reset (disconnect) */
+} cat_request_status_t;
+
+/* Completion: resp is NULL unless status is CAT_REQUEST_OK and the answer decoded.
+ * frame/len are the raw answer (NULL for timeouts and cancellation).
+ * rtt_ns is 0 when the answer came from the cache without a round trip. */
+typedef void (*cat_request_cb)(cat_request_status_t status, const cat_response_t *resp,
+                               const char *frame, size_t len, uint64_t rtt_ns, void *user_data);
+
+/* Hands one encoded frame to the transport (usually a queue push). 0 on success. */
+typedef int (*cat_pipeline_write_fn)(const char *frame, size_t len, void *io_data);
+
+typedef struct {
+    char wire[CAT_WIRE_MAX];
+    uint8_t len;
+    uint32_t key;               /* cat_request_key(), pairs the answer */
+    uint64_t tx_ns;             /* When the frame was first handed to the transport */
+    uint64_t deadline_ns;       /* Retry or fail once this passes */
+    uint8_t attempts;           /* Sends so far */
+    bool set;                   /* Queued set: written in turn, then noted, never in flight */
+    uint64_t seq;               /* Send order, shared with set marks */
+    cat_request_cb cb;
+    void *user_data;
+} cat_request_t;
+
+/* A set sent on the same link. The radio stays silent if it takes it, so it
+ * counts as accepted once a later read is answered or its deadline passes. */
+typedef struct {
+    uint64_t seq;
+    uint64_t tx_ns;
+    uint64_t deadline_ns;
+    cat_request_cb cb;
+    void *user_data;
+} cat_set_mark_t;
+
+/* Keeps up to depth reads outstanding and pairs answers by opcode + VFO */
+typedef struct {
+    cat_request_t backlog[CAT_PIPELINE_BACKLOG];
+    size_t backlog_head;        /* Monotonic */
+    size_t backlog_tail;
+    cat_request_t inflight[CAT_PIPELINE_MAX_DEPTH];     /* Oldest first */
+    size_t inflight_count;
+    cat_set_mark_t sets[CAT_PIPELINE_SETS];             /* Unconfirmed sets, oldest first */
+    size_t sets_head;           /* Monotonic */
+    size_t sets_tail;
+    uint64_t send_seq;
+    size_t depth;
+    uint64_t timeout_ns;        /* Deadline of the first send, doubled on each retry */
+    uint64_t max_timeout_ns;
+    unsigned max_retries;
+    cat_pipeline_write_fn write;
+    void *io_data;
+    cat_cache_t *cache;         /* Optional: fresh values answer reads locally */
+    uint64_t completed;
+    uint64_t failed;            /* Rejected, timed out or cancelled */
+    uint64_t retries;           /* Re-sends after a missed deadline */
+} cat_pipeline_t;
+
+/* Function Prototypes */
+void cat_pipeline_init(cat_pipeline_t *pipe, size_t depth, cat_pipeline_write_fn write, void *io_data);
+int cat_pipeline_submit(cat_pipeline_t *pipe, const cat_command_t *cmd, cat_request_cb cb, void *user_data);
+int cat_pipeline_submit_frame(cat_pipeline_t *pipe, const char *frame, size_t len,
+                              cat_request_cb cb, void *user_data);
+int cat_pipeline_submit_set(cat_pipeline_t *pipe, const char *frame, size_t len,
+                            cat_request_cb cb, void *user_data);
+void cat_pipeline_set_cache(cat_pipeline_t *pipe, cat_cache_t *cache);
+void cat_pipeline_note_set(cat_pipeline_t *pipe, cat_request_cb cb, void *user_data);
+void cat_pipeline_set_deadline(cat_pipeline_t *pipe, uint64_t timeout_ns, unsigned max_retries,
+                               uint64_t max_timeout_ns);
+size_t cat_pipeline_pump(cat_pipeline_t *pipe);
+bool cat_pipeline_on_frame(cat_pipeline_t *pipe, const char *frame, size_t len, uint64_t rx_ns);
+size_t cat_pipeline_expire(cat_pipeline_t *pipe, uint64_t now_ns);
+uint64_t cat_pipeline_next_deadline(const cat_pipeline_t *pipe);
+void cat_pipeline_cancel(cat_pipeline_t *pipe);
+size_t cat_pipeline_pending(const cat_pipeline_t *pipe);
+
+#endif /* CAT_PIPELINE_H */
@@ -0,0 +1,159 @@
+#include "cat_poller.h"
+#include <string.h>
+
+#define NS_PER_MS 1000000ull
+#define VARIABLE_ANSWER_COST 32     /* Guess for VE/RI, whose length is not fixed */
+
+void cat_poller_init(cat_poller_t *poller, int baudrate, unsigned budget_percent) {
+    if (!poller) return;
+
+    memset(poller, 0, sizeof(*poller));
+    if (budget_percent == 0 || budget_percent > 100) budget_percent = 50;
+
+    /* 8N1: ten bits per byte; answers share the line, so the budget counts both directions */
+    poller->budget_bps = (baudrate > 0 ? baudrate : 38400) / 10.0 * budget_percent / 100.0;
+    poller->burst = poller->budget_bps / 10.0;  /* 100 ms worth */
+    if (poller->burst < 64) poller->burst = 64;
+    poller->tokens = poller->burst;
+    poller->backoff_pct = 100;
+}
+
+/* Register a read built by one of the cat_build_*_read() functions. Returns its index. */
+int cat_poller_add(cat_poller_t *poller, const cat_command_t *read_cmd, uint32_t interval_ms,
+                   uint8_t priority, bool ai_covered) {
+    if (!poller || !read_cmd || poller->count == CAT_POLLER_MAX_PARAMS) return -1;
+
+    cat_poll_param_t *param = &poller->params[poller->count];
+    int len = cat_encode_command(read_cmd, param->wire, sizeof(param->wire));
+    if (len < 0 || !cat_is_read_request(param->wire, (size_t)len)) return -1;
+
+    int answer = cat_get_response_length(param->wire);
+    param->len = (uint8_t)len;
+    param->cost = (uint16_t)(len + (answer > 0 ? answer : VARIABLE_ANSWER_COST));
+    param->key = cat_request_key(param->wire, param->len);
+    param->interval_ms = interval_ms ? interval_ms : 1;
+    param->priority = priority;
+    param->ai_covered = ai_covered;
+    param->in_flight = false;
+    param->next_due_ns = 0;
+    param->updated_ns = 0;
+    param->poller = poller;
+    return (int)poller->count++;
+}
+
+void cat_poller_set_auto_info(cat_poller_t *poller, bool enabled) {
+    if (poller) poller->auto_info = enabled;
+}
+
+static uint64_t effective_interval_ns(const cat_poller_t *poller, const cat_poll_param_t *param) {
+    uint64_t interval = param->interval_ms;
+    if (param->ai_covered && poller->auto_info && interval < CAT_POLLER_AI_RESYNC_MS) {
+        interval = CAT_POLLER_AI_RESYNC_MS;
+    }
+    return interval * NS_PER_MS * poller->backoff_pct / 100;
+}
+
+/* Forget timing state and schedule every first poll one interval after now_ns,
+ * for callers that have just read everything themselves. Parameters are kept. */
+void cat_poller_reset(cat_poller_t *poller, uint64_t now_ns) {
+    if (!poller) return;
+
+    poller->tokens = poller->burst;
+    poller->refill_ns = 0;
+    poller->backoff_pct = 100;
+    poller->srtt_ns = 0;
+    poller->best_rtt_ns = 0;
+    for (size_t i = 0; i < poller->count; i++) {
+        poller->params[i].in_flight = false;
+        poller->params[i].next_due_ns = now_ns + effective_interval_ns(poller, &poller->params[i]);
+        poller->params[i].updated_ns = 0;
+    }
+}
+
+/* Slow answers mean a busy radio or link: stretch every interval, relax once it recovers */
+static void adapt(cat_poller_t *poller, cat_request_status_t status, uint64_t rtt_ns) {
+    if (status == CAT_REQUEST_TIMEOUT) {
+        poller->timeouts++;
+        poller->backoff_pct *= 2;
+    } else if (status == CAT_REQUEST_OK) {
+        poller->srtt_ns = poller->srtt_ns ? (poller->srtt_ns * 7 + rtt_ns) / 8 : rtt_ns;
+        if (!poller->best_rtt_ns || rtt_ns < poller->best_rtt_ns) poller->best_rtt_ns = rtt_ns;
+
+        if (poller->srtt_ns > 2 * poller->best_rtt_ns) {
+            poller->backoff_pct += poller->backoff_pct / 2;
+        } else if (poller->srtt_ns * 4 < poller->best_rtt_ns * 5 && poller->backoff_pct > 100) {
+            poller->backoff_pct -= (poller->backoff_pct - 100 + 9) / 10;
+        }
+    }
+    if (poller->backoff_pct > CAT_POLLER_MAX_BACKOFF) poller->backoff_pct = CAT_POLLER_MAX_BACKOFF;
+}
+
+static void on_poll_done(cat_request_status_t status, const cat_response_t *resp,
+                         const char *frame, size_t len, uint64_t rtt_ns, void *user_data) {
+    (void)resp;
+    (void)frame;
+    (void)len;
+    cat_poll_param_t *param = (cat_poll_param_t *)user_data;
+
+    param->in_flight = false;
+    /* A cached answer says nothing about the link */
+    if (status != CAT_REQUEST_CANCELLED && !(status == CAT_REQUEST_OK && rtt_ns == 0)) {
+        adapt(param->poller, status, rtt_ns);
+    }
+}
+
+static void refill(cat_poller_t *poller, uint64_t now_ns) {
+    if (poller->refill_ns && now_ns > poller->refill_ns) {
+        poller->tokens += poller->budget_bps * (double)(now_ns - poller->refill_ns) / 1e9;
+        if (poller->tokens > poller->burst) poller->tokens = poller->burst;
+    }
+    poller->refill_ns = now_ns;
+}
+
+/* Submit due reads, highest priority first, while the byte budget lasts.
+ * Returns the number submitted; the caller pumps the pipeline afterwards. */
+size_t cat_poller_run(cat_poller_t *poller, cat_pipeline_t *pipeline, uint64_t now_ns) {
+    if (!poller || !pipeline) return 0;
+
+    refill(poller, now_ns);
+
+    size_t submitted = 0;
+    for (;;) {
+        cat_poll_param_t *best = NULL;
+        for (size_t i = 0; i < poller->count; i++) {
+            cat_poll_param_t *param = &poller->params[i];
+            if (param->in_flight || param->next_due_ns > now_ns) continue;
+            if (!best || param->priority > best->priority ||
+                (param->priority == best->priority && param->next_due_ns < best->next_due_ns)) {
+                best = param;
+            }
+        }
+        if (!best || poller->tokens < best->cost) break;
+
+        if (cat_pipeline_submit_frame(pipeline, best->wire, best->len, on_poll_done, best) != 0) break;
+
+        poller->tokens -= best->cost;
+        best->in_flight = true;
+        best->next_due_ns = now_ns + effective_interval_ns(poller, best);
+        poller->polls++;
+        submitted++;
+    }
+    return submitted;
+}
+
+/* Any answer or AI push refreshes the matching value and postpones its poll */
+void cat_poller_note_frame(cat_poller_t *poller, const char *frame, size_t len, uint64_t rx_ns) {
+    if (!poller) return;
+
+    uint32_t key = cat_request_key(frame, len);
+    if (key == 0) return;
+
+    for (size_t i = 0; i < poller->count; i++) {
+        cat_poll_param_t *param = &poller->params[i];
+        if (param->key != key) continue;
+
+        param->updated_ns = rx_ns;
+        uint64_t due = rx_ns + effective_interval_ns(poller, param);
+        if (!param->in_flight && due > param->next_due_ns) param->next_due_ns = due;
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef CAT_POLLER_H
+#define CAT_POLLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ftx1_cat.h"
+#include "cat_pipeline.h"
+
+#define CAT_POLLER_MAX_PARAMS   32
+#define CAT_POLLER_AI_RESYNC_MS 30000   /* AI-covered values are still checked this often */
+#define CAT_POLLER_MAX_BACKOFF  800     /* Interval scale limit, percent */
+
+/* One polled value, registered from a cat_build_*_read() command */
+typedef struct {
+    char wire[CAT_WIRE_MAX];
+    uint8_t len;
+    uint16_t cost;              /* Request plus expected answer, bytes on the bus */
+    uint32_t key;               /* cat_request_key(), matches AI pushes too */
+    uint32_t interval_ms;       /* Target refresh interval */
+    uint8_t priority;           /* Higher is polled first when the budget is short */
+    bool ai_covered;            /* Pushed by AI1, polled only as a slow resync */
+    bool in_flight;
+    uint64_t next_due_ns;
+    uint64_t updated_ns;        /* Last answer or push */
+    struct cat_poller *poller;
+} cat_poll_param_t;
+
+/* Chooses which reads to send: due first, by priority, within a byte budget */
+typedef struct cat_poller {
+    cat_poll_param_t params[CAT_POLLER_MAX_PARAMS];
+    size_t count;
+    double budget_bps;          /* Bytes per second polling may use */
+    double tokens;              /* Byte bucket, refilled at budget_bps */
+    double burst;               /* Bucket capacity */
+    uint64_t refill_ns;
+    bool auto_info;             /* AI1 is on, covered values come for free */
+    uint32_t backoff_pct;       /* Scale on every interval, 100 = nominal */
+    uint64_t srtt_ns;           /* Smoothed round trip */
+    uint64_t best_rtt_ns;       /* Fastest round trip seen, the idle link reference */
+    uint64_t polls;
+    uint64_t timeouts;
+} cat_poller_t;
+
+/* Function Prototypes */
+void cat_poller_init(cat_poller_t *poller, int baudrate, unsigned budget_percent);
+int cat_poller_add(cat_poller_t *poller, const cat_command_t *read_cmd, uint32_t interval_ms,
+                   uint8_t priority, bool ai_covered);
+void cat_poller_set_auto_info(cat_poller_t *poller, bool enabled);
+size_t cat_poller_run(cat_poller_t *poller, cat_pipeline_t *pipeline, uint64_t now_ns);
+void cat_poller_note_frame(cat_poller_t *poller, const char *frame, size_t len, uint64_t rx_ns);
+void cat_poller_reset(cat_poller_t *poller, uint64_t now_ns);
+
+#endif /* CAT_POLLER_H */
@@ -0,0 +1,105 @@
+#include "cat_rtt.h"
+#include "ftx1_cat.h"
+#include <string.h>
+
+void cat_rtt_reset(cat_rtt_t *rtt) {
+    if (!rtt) return;
+    memset(rtt, 0, sizeof(*rtt));
+}
+
+static void remove_pending(cat_rtt_t *rtt, size_t index) {
+    memmove(&rtt->pending[index], &rtt->pending[index + 1],
+            (rtt->count - index - 1) * sizeof(rtt->pending[0]));
+    rtt->count--;
+}
+
+/* Track a command queued for transmission. Returns 0 if an answer is expected, -1 for sets. */
+int cat_rtt_expect(cat_rtt_t *rtt, const char *frame, size_t len, size_t wire_end) {
+    if (!rtt || !cat_is_read_request(frame, len)) return -1;
+
+    uint32_t key = cat_request_key(frame, len);
+    if (key == 0) return -1;
+
+    if (rtt->count == CAT_RTT_SLOTS) {
+        remove_pending(rtt, 0);
+        rtt->expired++;
+    }
+
+    cat_rtt_request_t *req = &rtt->pending[rtt->count++];
+    req->key = key;
+    req->wire_end = wire_end;
+    req->tx_ns = 0;
+    return 0;
+}
+
+/* Stamp every queued request whose last byte went out with the write that returned at tx_ns */
+void cat_rtt_sent(cat_rtt_t *rtt, size_t wire_sent, uint64_t tx_ns) {
+    if (!rtt) return;
+
+    for (size_t i = 0; i < rtt->count; i++) {
+        cat_rtt_request_t *req = &rtt->pending[i];
+        if (req->tx_ns == 0 && req->wire_end <= wire_sent) {
+            req->tx_ns = tx_ns;
+        }
+    }
+}
+
+/* Pair an answer with the oldest sent request of the same key.
+ * Returns the round trip in nanoseconds, or -1 for unsolicited frames (AI pushes, errors). */
+int64_t cat_rtt_match(cat_rtt_t *rtt, const char *frame, size_t len, uint64_t rx_ns) {
+    if (!rtt || rtt->count == 0) return -1;
+
+    uint32_t key = cat_request_key(frame, len);
+    if (key == 0) return -1;
+
+    for (size_t i = 0; i < rtt->count; i++) {
+        cat_rtt_request_t *req = &rtt->pending[i];
+        if (req->key != key || req->tx_ns == 0) continue;
+
+        uint64_t elapsed = rx_ns > req->tx_ns ? rx_ns - req->tx_ns : 0;
+        remove_pending(rtt, i);
+
+        if (rtt->samples == 0 || elapsed < rtt->min_ns) rtt->min_ns = elapsed;
+        if (elapsed > rtt->max_ns) rtt->max_ns = elapsed;
+        rtt->last_ns = elapsed;
+        rtt->total_ns += elapsed;
+        rtt->samples++;
+        return (int64_t)elapsed;
+    }
+    return -1;
+}
+
+uint64_t cat_rtt_average_ns(const cat_rtt_t *rtt) {
+    return (rtt && rtt->samples) ? rtt->total_ns / rtt->samples : 0;
+}
+
+/* Drop sent requests that waited longer than timeout_ns. Returns how many were dropped. */
+size_t cat_rtt_expire(cat_rtt_t *rtt, uint64_t now_ns, uint64_t timeout_ns) {
+    if (!rtt) return 0;
+
+    size_t dropped = 0;
+    size_t i = 0;
+    while (i < rtt->count) {
+        const cat_rtt_request_t *req = &rtt->pending[i];
+        if (req->tx_ns != 0 && now_ns - req->tx_ns >= timeout_ns) {
+            remove_pending(rtt, i);
+            dropped++;
+        } else {
+            i++;
+        }
+    }
+    rtt->timeouts += dropped;
+    return dropped;
+}
+
+/* When the oldest sent request runs out of time, 0 if none is waiting */
+uint64_t cat_rtt_next_deadline(const cat_rtt_t *rtt, uint64_t timeout_ns) {
+    if (!rtt) return 0;
+
+    uint64_t first = 0;
+    for (size_t i = 0; i < rtt->count; i++) {
+        uint64_t tx = rtt->pending[i].tx_ns;
+        if (tx != 0 && (first == 0 || tx < first)) first = tx;
+    }
+    return first ? first + timeout_ns : 0;
+}
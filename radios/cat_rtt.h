@@ -0,0 +1,39 @@
+#ifndef CAT_RTT_H
+#define CAT_RTT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CAT_RTT_SLOTS 32    /* Outstanding reads tracked, the oldest is dropped beyond */
+#define CAT_RTT_TIMEOUT_NS 1000000000ull    /* Default wait for an answer */
+
+/* One read waiting for its answer */
+typedef struct {
+    uint32_t key;           /* cat_request_key() of the command */
+    size_t wire_end;        /* TX byte count at which the command is fully written */
+    uint64_t tx_ns;         /* CLOCK_MONOTONIC time of the write, 0 while still queued */
+} cat_rtt_request_t;
+
+/* Pairs answers with the reads that asked for them and keeps round-trip statistics */
+typedef struct {
+    cat_rtt_request_t pending[CAT_RTT_SLOTS];   /* Oldest first */
+    size_t count;
+    uint64_t last_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t total_ns;
+    uint64_t samples;
+    uint64_t expired;       /* Requests pushed out before an answer arrived */
+    uint64_t timeouts;      /* Requests dropped by cat_rtt_expire() */
+} cat_rtt_t;
+
+/* Function Prototypes */
+void cat_rtt_reset(cat_rtt_t *rtt);
+int cat_rtt_expect(cat_rtt_t *rtt, const char *frame, size_t len, size_t wire_end);
+void cat_rtt_sent(cat_rtt_t *rtt, size_t wire_sent, uint64_t tx_ns);
+int64_t cat_rtt_match(cat_rtt_t *rtt, const char *frame, size_t len, uint64_t rx_ns);
+uint64_t cat_rtt_average_ns(const cat_rtt_t *rtt);
+size_t cat_rtt_expire(cat_rtt_t *rtt, uint64_t now_ns, uint64_t timeout_ns);
+uint64_t cat_rtt_next_deadline(const cat_rtt_t *rtt, uint64_t timeout_ns);
+
+#endif /* CAT_RTT_H */
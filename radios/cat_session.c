@@ -0,0 +1,79 @@
+#include "cat_session.h"
+#include <sys/ioctl.h>
+#include <termios.h>
+
+void cat_session_init(cat_session_t *session, int cat1_fd, int cat2_fd) {
+    if (!session) return;
+
+    session->fd[CAT_PORT_1] = cat1_fd;
+    session->fd[CAT_PORT_2] = cat2_fd;
+    tx_queue_reset(&session->txq[CAT_PORT_1]);
+    tx_queue_reset(&session->txq[CAT_PORT_2]);
+    session->ptt_method = CAT_PTT_COMMAND;
+    session->transmitting = false;
+}
+
+/* TX control goes to CAT-2 when it is open; CAT-1 accepts everything otherwise */
+cat_port_t cat_session_route(const cat_session_t *session, const char *frame, size_t len) {
+    if (session->fd[CAT_PORT_2] >= 0 && cat_command_class(frame, len) == CAT_CLASS_TX) {
+        return CAT_PORT_2;
+    }
+    return CAT_PORT_1;
+}
+
+/* Append a frame to its port's queue without writing. Returns the port, or -1 if full. */
+int cat_session_queue(cat_session_t *session, const char *frame, size_t len) {
+    if (!session || !frame) return -1;
+
+    cat_port_t port = cat_session_route(session, frame, len);
+    if (session->fd[port] < 0) return -1;
+    if (tx_queue_push(&session->txq[port], frame, len) != 0) return -1;
+    return port;
+}
+
+ssize_t cat_session_flush(cat_session_t *session, cat_port_t port) {
+    if (!session || session->fd[port] < 0) return -1;
+    return tx_queue_flush(&session->txq[port], session->fd[port]);
+}
+
+/* One writev per port, the TX port first. -1 if either port failed. */
+int cat_session_flush_all(cat_session_t *session) {
+    if (!session) return -1;
+
+    int rc = 0;
+    if (session->fd[CAT_PORT_2] >= 0 && cat_session_flush(session, CAT_PORT_2) < 0) rc = -1;
+    if (session->fd[CAT_PORT_1] >= 0 && cat_session_flush(session, CAT_PORT_1) < 0) rc = -1;
+    return rc;
+}
+
+/* Queue and write immediately. Returns the port used, or -1. */
+int cat_session_send(cat_session_t *session, const char *frame, size_t len) {
+    int port = cat_session_queue(session, frame, len);
+    if (port < 0) return -1;
+    if (cat_session_flush(session, (cat_port_t)port) < 0) return -1;
+    return port;
+}
+
+/* Key or unkey. Modem-line PTT bypasses the queues entirely. */
+int cat_session_set_ptt(cat_session_t *session, bool transmit) {
+    if (!session) return -1;
+
+    if (session->ptt_method != CAT_PTT_COMMAND) {
+        int fd = session->fd[CAT_PORT_2];
+        int bits = session->ptt_method == CAT_PTT_RTS ? TIOCM_RTS : TIOCM_DTR;
+        if (fd < 0 || ioctl(fd, transmit ? TIOCMBIS : TIOCMBIC, &bits) < 0) return -1;
+    } else {
+        cat_command_t cmd;
+        char wire[CAT_WIRE_MAX];
+        cat_build_ptt_set(&cmd, transmit);
+        int len = cat_encode_command(&cmd, wire, sizeof(wire));
+        if (len < 0 || cat_session_send(session, wire, (size_t)len) < 0) return -1;
+    }
+
+    session->transmitting = transmit;
+    return 0;
+}
+
+bool cat_session_pending(const cat_session_t *session, cat_port_t port) {
+    return session && !tx_queue_empty(&session->txq[port]);
+}
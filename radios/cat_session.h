@@ -0,0 +1,43 @@
+#ifndef CAT_SESSION_H
+#define CAT_SESSION_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include "ftx1_cat.h"
+#include "../serial/tx_queue.h"
+
+/* The two virtual COM ports of one radio */
+typedef enum {
+    CAT_PORT_1 = 0,     /* Enhanced COM port: frequency, mode, polling */
+    CAT_PORT_2 = 1,     /* Standard COM port: PTT, CW keying, digital TX */
+    CAT_PORT_COUNT
+} cat_port_t;
+
+/* How cat_session_set_ptt() keys the transmitter */
+typedef enum {
+    CAT_PTT_COMMAND,    /* TX1; / TX0; on the TX port */
+    CAT_PTT_RTS,        /* RTS line of CAT-2 (RPTT SELECT = RTS on the radio) */
+    CAT_PTT_DTR         /* DTR line of CAT-2 (RPTT SELECT = DTR on the radio) */
+} cat_ptt_method_t;
+
+/* Both ports of one radio, each with its own write queue so TX control
+ * never waits behind polling traffic. Reading stays with the caller. */
+typedef struct {
+    int fd[CAT_PORT_COUNT];             /* -1 when the port is not open */
+    tx_queue_t txq[CAT_PORT_COUNT];
+    cat_ptt_method_t ptt_method;
+    bool transmitting;
+} cat_session_t;
+
+/* Function Prototypes */
+void cat_session_init(cat_session_t *session, int cat1_fd, int cat2_fd);
+cat_port_t cat_session_route(const cat_session_t *session, const char *frame, size_t len);
+int cat_session_queue(cat_session_t *session, const char *frame, size_t len);
+int cat_session_send(cat_session_t *session, const char *frame, size_t len);
+ssize_t cat_session_flush(cat_session_t *session, cat_port_t port);
+int cat_session_flush_all(cat_session_t *session);
+int cat_session_set_ptt(cat_session_t *session, bool transmit);
+bool cat_session_pending(const cat_session_t *session, cat_port_t port);
+
+#endif /* CAT_SESSION_H */
@@ -0,0 +1,184 @@
+#include "cat_snapshot.h"
+#include "cat_framer.h"
+#include "../serial/tx_queue.h"
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+
+static void store(cat_snapshot_t *snap, const cat_response_t *resp) {
+    switch (resp->type) {
+        case CAT_RESP_FREQUENCY:
+            snap->frequency[resp->data.frequency.vfo] = resp->data.frequency;
+            snap->valid |= resp->data.frequency.vfo == VFO_MAIN ? CAT_SNAP_FREQUENCY_A : CAT_SNAP_FREQUENCY_B;
+            break;
+        case CAT_RESP_MODE:
+            snap->mode[resp->data.mode.vfo] = resp->data.mode;
+            snap->valid |= CAT_SNAP_MODE << resp->data.mode.vfo;
+            break;
+        case CAT_RESP_AF_GAIN:
+            snap->af_gain[resp->data.af_gain.vfo] = resp->data.af_gain;
+            snap->valid |= CAT_SNAP_AF_GAIN << resp->data.af_gain.vfo;
+            break;
+        case CAT_RESP_RF_GAIN:
+            snap->rf_gain[resp->data.rf_gain.vfo] = resp->data.rf_gain;
+            snap->valid |= CAT_SNAP_RF_GAIN << resp->data.rf_gain.vfo;
+            break;
+        case CAT_RESP_SQUELCH:
+            snap->squelch[resp->data.squelch.vfo] = resp->data.squelch;
+            snap->valid |= CAT_SNAP_SQUELCH << resp->data.squelch.vfo;
+            break;
+        case CAT_RESP_AGC:
+            snap->agc[resp->data.agc.vfo] = resp->data.agc;
+            snap->valid |= CAT_SNAP_AGC << resp->data.agc.vfo;
+            break;
+        case CAT_RESP_CTCSS:
+            snap->ctcss[resp->data.ctcss.vfo] = resp->data.ctcss;
+            snap->valid |= CAT_SNAP_CTCSS << resp->data.ctcss.vfo;
+            break;
+        case CAT_RESP_POWER:
+            snap->power = resp->data.power;
+            snap->valid |= CAT_SNAP_POWER;
+            break;
+        case CAT_RESP_SPLIT:
+            snap->split = resp->data.split;
+            snap->valid |= CAT_SNAP_SPLIT;
+            break;
+        default:
+            break;
+    }
+}
+
+static void on_answer(cat_request_status_t status, const cat_response_t *resp,
+                      const char *frame, size_t len, uint64_t rtt_ns, void *user_data) {
+    (void)frame;
+    (void)len;
+    (void)rtt_ns;
+    cat_snapshot_t *snap = (cat_snapshot_t *)user_data;
+
+    if (status == CAT_REQUEST_OK && resp) store(snap, resp);
+    else snap->failed++;
+
+    if (snap->outstanding && --snap->outstanding == 0) {
+        snap->elapsed_ns = cat_monotonic_ns() - snap->start_ns;
+        if (snap->done) snap->done(snap, snap->user_data);
+    }
+}
+
+/* Queue every snapshot read on the pipeline; done runs once all have completed.
+ * The caller pumps and flushes as for any other request. */
+int cat_snapshot_start(cat_snapshot_t *snap, cat_pipeline_t *pipe, cat_snapshot_cb done, void *user_data) {
+    if (!snap || !pipe) return -1;
+
+    cat_command_t cmds[CAT_SNAPSHOT_READS];
+    size_t count = 0;
+
+    cat_build_frequency_read(&cmds[count++], VFO_MAIN);
+    cat_build_frequency_read(&cmds[count++], VFO_SUB);
+    for (int vfo = VFO_MAIN; vfo <= VFO_SUB; vfo++) {
+        cat_build_mode_read(&cmds[count++], vfo);
+        cat_build_af_gain_read(&cmds[count++], vfo);
+        cat_build_rf_gain_read(&cmds[count++], vfo);
+        cat_build_squelch_read(&cmds[count++], vfo);
+        cat_build_agc_read(&cmds[count++], vfo);
+        cat_build_ctcss_read(&cmds[count++], vfo);
+    }
+    cat_build_power_read(&cmds[count++]);
+    cat_build_split_read(&cmds[count++]);
+
+    memset(snap, 0, sizeof(*snap));
+    snap->done = done;
+    snap->user_data = user_data;
+    snap->start_ns = cat_monotonic_ns();
+
+    for (size_t i = 0; i < count; i++) {
+        if (cat_pipeline_submit(pipe, &cmds[i], on_answer, snap) == 0) {
+            snap->outstanding++;
+        } else {
+            snap->failed++;
+        }
+    }
+    return snap->outstanding ? 0 : -1;
+}
+
+bool cat_snapshot_complete(const cat_snapshot_t *snap) {
+    return snap && (snap->valid & CAT_SNAP_ALL) == CAT_SNAP_ALL;
+}
+
+/* Blocking variant for tools: its own pipeline, framer and queue on fd */
+typedef struct {
+    int fd;
+    tx_queue_t txq;
+    cat_framer_t framer;
+    cat_pipeline_t pipe;
+} snapshot_link_t;
+
+static int link_write(const char *frame, size_t len, void *io_data) {
+    snapshot_link_t *link = (snapshot_link_t *)io_data;
+    return tx_queue_push(&link->txq, frame, len);
+}
+
+static void link_frames(const cat_frame_t *frames, size_t count, void *user_data) {
+    snapshot_link_t *link = (snapshot_link_t *)user_data;
+
+    for (size_t i = 0; i < count; i++) {
+        cat_pipeline_on_frame(&link->pipe, frames[i].data, frames[i].len, frames[i].rx_ns);
+    }
+}
+
+/* Read a snapshot over fd with up to depth reads in flight (1 = one at a time).
+ * A read unanswered after timeout_ms is sent again with the pipeline's retry policy.
+ * Returns 0 if every value arrived, -1 otherwise. */
+int cat_snapshot_read(int fd, cat_snapshot_t *snap, size_t depth, int timeout_ms) {
+    if (fd < 0 || !snap || timeout_ms <= 0) return -1;
+
+    snapshot_link_t link;
+    link.fd = fd;
+    tx_queue_reset(&link.txq);
+    cat_framer_reset(&link.framer);
+    cat_pipeline_init(&link.pipe, depth, link_write, &link);
+    cat_pipeline_set_deadline(&link.pipe, (uint64_t)timeout_ms * 1000000ull, CAT_PIPELINE_RETRIES,
+                              CAT_PIPELINE_MAX_TIMEOUT_NS);
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) return -1;
+
+    int rc = cat_snapshot_start(snap, &link.pipe, NULL, NULL);
+
+    while (rc == 0 && cat_pipeline_pending(&link.pipe)) {
+        cat_pipeline_pump(&link.pipe);
+        if (tx_queue_flush(&link.txq, fd) < 0) {
+            rc = -1;
+            break;
+        }
+
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (!tx_queue_empty(&link.txq)) pfd.events |= POLLOUT;
+
+        /* Sleep until the earliest deadline at most */
+        int wait_ms = timeout_ms;
+        uint64_t deadline = cat_pipeline_next_deadline(&link.pipe);
+        if (deadline) {
+            uint64_t now = cat_monotonic_ns();
+            wait_ms = deadline > now ? (int)((deadline - now + 999999) / 1000000) : 0;
+        }
+
+        int n = poll(&pfd, 1, wait_ms);
+        if (n < 0 && errno != EINTR) {
+            rc = -1;
+            break;
+        }
+        if (n > 0 && (pfd.revents & (POLLIN | POLLHUP | POLLERR))) {
+            if (cat_framer_read_fd(&link.framer, fd, link_frames, &link) < 0 ||
+                (pfd.revents & (POLLHUP | POLLERR))) {
+                rc = -1;
+                break;
+            }
+        }
+        cat_pipeline_expire(&link.pipe, cat_monotonic_ns());
+    }
+
+    cat_pipeline_cancel(&link.pipe);
+    fcntl(fd, F_SETFL, flags);
+    return rc == 0 && cat_snapshot_complete(snap) ? 0 : -1;
+}
@@ -0,0 +1,53 @@
+#ifndef CAT_SNAPSHOT_H
+#define CAT_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ftx1_cat.h"
+#include "cat_pipeline.h"
+
+/* Values read by a snapshot, one bit each in cat_snapshot_t.valid */
+enum {
+    CAT_SNAP_FREQUENCY_A = 1u << 0,
+    CAT_SNAP_FREQUENCY_B = 1u << 1,
+    CAT_SNAP_MODE        = 1u << 2,     /* Shifted by the VFO: << 1 for the sub */
+    CAT_SNAP_AF_GAIN     = 1u << 4,
+    CAT_SNAP_RF_GAIN     = 1u << 6,
+    CAT_SNAP_SQUELCH     = 1u << 8,
+    CAT_SNAP_AGC         = 1u << 10,
+    CAT_SNAP_CTCSS       = 1u << 12,
+    CAT_SNAP_POWER       = 1u << 14,
+    CAT_SNAP_SPLIT       = 1u << 15,
+    CAT_SNAP_ALL         = (1u << 16) - 1
+};
+#define CAT_SNAPSHOT_READS 16
+
+/* Whole radio state from one pipelined burst; per-VFO arrays are indexed by vfo_select_t */
+typedef struct cat_snapshot {
+    frequency_info_t frequency[2];
+    mode_info_t mode[2];
+    gain_info_t af_gain[2];
+    gain_info_t rf_gain[2];
+    squelch_info_t squelch[2];
+    agc_info_t agc[2];
+    ctcss_info_t ctcss[2];
+    power_info_t power;
+    split_info_t split;
+    uint32_t valid;             /* CAT_SNAP_* bits answered and decoded */
+    unsigned outstanding;       /* Reads not completed yet */
+    unsigned failed;            /* Rejected, timed out or cancelled */
+    uint64_t start_ns;
+    uint64_t elapsed_ns;        /* Wall time from submit to the last completion */
+    void (*done)(struct cat_snapshot *snap, void *user_data);
+    void *user_data;
+} cat_snapshot_t;
+
+typedef void (*cat_snapshot_cb)(cat_snapshot_t *snap, void *user_data);
+
+/* Function Prototypes */
+int cat_snapshot_start(cat_snapshot_t *snap, cat_pipeline_t *pipe, cat_snapshot_cb done, void *user_data);
+int cat_snapshot_read(int fd, cat_snapshot_t *snap, size_t depth, int timeout_ms);
+bool cat_snapshot_complete(const cat_snapshot_t *snap);
+
+#endif /* CAT_SNAPSHOT_H */
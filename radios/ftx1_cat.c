@@ -1,487 +1,730 @@
 #include "ftx1_cat.h"
-#include <stdio.h>
 #include <string.h>
-#include <stdlib.h>
 
 /* Command Building Functions */
 
-int cat_build_frequency_set(cat_command_t *cmd, vfo_select_t vfo, uint32_t freq_hz) {
-    if (!cmd) return -1;
-    
-    if (vfo == VFO_MAIN) {
-        strcpy(cmd->cmd, "FA");
-    } else {
-        strcpy(cmd->cmd, "FB");
+/* Builders write fixed-width fields straight into the command, no printf */
+
+static inline void set_opcode(cat_command_t *cmd, char a, char b, cat_cmd_type_t type) {
+    cmd->cmd[0] = a;
+    cmd->cmd[1] = b;
+    cmd->cmd[2] = '\0';
+    cmd->params[0] = '\0';
+    cmd->params_len = 0;
+    cmd->has_params = false;
+    cmd->type = type;
+}
+
+static inline void put_char(cat_command_t *cmd, char c) {
+    cmd->params[cmd->params_len++] = c;
+    cmd->params[cmd->params_len] = '\0';
+    cmd->has_params = true;
+}
+
+/* Zero-padded decimal field of exactly 'width' digits */
+static inline void put_digits(cat_command_t *cmd, uint32_t value, unsigned width) {
+    char *p = cmd->params + cmd->params_len + width;
+
+    *p = '\0';
+    cmd->params_len += (uint8_t)width;
+    cmd->has_params = true;
+    while (width--) {
+        *--p = (char)('0' + value % 10);
+        value /= 10;
     }
+}
+
+/* MD takes the mode as one character: '1'-'9', then 'A' for 10 and up */
+static inline char mode_char(operating_mode_t mode) {
+    return (mode < 10) ? (char)('0' + mode) : (char)('A' + (mode - 10));
+}
+
+int cat_build_frequency_set(cat_command_t *cmd, vfo_select_t vfo, uint32_t freq_hz) {
+    if (!cmd || freq_hz > 999999999) return -1;
     
-    snprintf(cmd->params, sizeof(cmd->params), "%09u", freq_hz);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'F', (vfo == VFO_MAIN) ? 'A' : 'B', CAT_CMD_SET);
+    put_digits(cmd, freq_hz, 9);
     return 0;
 }
 
 int cat_build_frequency_read(cat_command_t *cmd, vfo_select_t vfo) {
     if (!cmd) return -1;
     
-    if (vfo == VFO_MAIN) {
-        strcpy(cmd->cmd, "FA");
-    } else {
-        strcpy(cmd->cmd, "FB");
-    }
-    
-    cmd->params[0] = '\0';
-    cmd->has_params = false;
-    cmd->type = CAT_CMD_READ;
+    set_opcode(cmd, 'F', (vfo == VFO_MAIN) ? 'A' : 'B', CAT_CMD_READ);
     return 0;
 }
 
 int cat_build_mode_set(cat_command_t *cmd, vfo_select_t vfo, operating_mode_t mode) {
-    if (!cmd) return -1;
+    if (!cmd || mode < MODE_LSB || mode > MODE_C4FM) return -1;
     
-    strcpy(cmd->cmd, "MD");
-    snprintf(cmd->params, sizeof(cmd->params), "%d%02d", vfo, mode);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'M', 'D', CAT_CMD_SET);
+    put_digits(cmd, vfo, 1);
+    put_char(cmd, mode_char(mode));
     return 0;
 }
 
 int cat_build_mode_read(cat_command_t *cmd, vfo_select_t vfo) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "MD");
-    snprintf(cmd->params, sizeof(cmd->params), "%d", vfo);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_READ;
+    set_opcode(cmd, 'M', 'D', CAT_CMD_READ);
+    put_digits(cmd, vfo, 1);
     return 0;
 }
 
 int cat_build_af_gain_set(cat_command_t *cmd, vfo_select_t vfo, uint8_t level) {
-    if (!cmd || level > 255) return -1;
+    if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "AG");
-    snprintf(cmd->params, sizeof(cmd->params), "%d%03d", vfo, level);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'A', 'G', CAT_CMD_SET);
+    put_digits(cmd, vfo, 1);
+    put_digits(cmd, level, 3);
     return 0;
 }
 
 int cat_build_af_gain_read(cat_command_t *cmd, vfo_select_t vfo) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "AG");
-    snprintf(cmd->params, sizeof(cmd->params), "%d", vfo);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_READ;
+    set_opcode(cmd, 'A', 'G', CAT_CMD_READ);
+    put_digits(cmd, vfo, 1);
     return 0;
 }
 
 int cat_build_rf_gain_set(cat_command_t *cmd, vfo_select_t vfo, uint8_t level) {
-    if (!cmd || level > 255) return -1;
+    if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "RG");
-    snprintf(cmd->params, sizeof(cmd->params), "%d%03d", vfo, level);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'R', 'G', CAT_CMD_SET);
+    put_digits(cmd, vfo, 1);
+    put_digits(cmd, level, 3);
     return 0;
 }
 
 int cat_build_rf_gain_read(cat_command_t *cmd, vfo_select_t vfo) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "RG");
-    snprintf(cmd->params, sizeof(cmd->params), "%d", vfo);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_READ;
+    set_opcode(cmd, 'R', 'G', CAT_CMD_READ);
+    put_digits(cmd, vfo, 1);
     return 0;
 }
 
 int cat_build_squelch_set(cat_command_t *cmd, vfo_select_t vfo, uint8_t level) {
-    if (!cmd || level > 255) return -1;
+    if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "SQ");
-    snprintf(cmd->params, sizeof(cmd->params), "%d%03d", vfo, level);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'S', 'Q', CAT_CMD_SET);
+    put_digits(cmd, vfo, 1);
+    put_digits(cmd, level, 3);
     return 0;
 }
 
 int cat_build_squelch_read(cat_command_t *cmd, vfo_select_t vfo) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "SQ");
-    snprintf(cmd->params, sizeof(cmd->params), "%d", vfo);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_READ;
+    set_opcode(cmd, 'S', 'Q', CAT_CMD_READ);
+    put_digits(cmd, vfo, 1);
     return 0;
 }
 
 int cat_build_power_set(cat_command_t *cmd, uint8_t watts) {
     if (!cmd || watts < 5 || watts > 100) return -1;
     
-    strcpy(cmd->cmd, "PC");
-    snprintf(cmd->params, sizeof(cmd->params), "%03d", watts);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'P', 'C', CAT_CMD_SET);
+    put_digits(cmd, watts, 3);
     return 0;
 }
 
 int cat_build_power_read(cat_command_t *cmd) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "PC");
-    cmd->params[0] = '\0';
-    cmd->has_params = false;
-    cmd->type = CAT_CMD_READ;
+    set_opcode(cmd, 'P', 'C', CAT_CMD_READ);
     return 0;
 }
 
 int cat_build_agc_set(cat_command_t *cmd, vfo_select_t vfo, agc_type_t agc) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "GT");
-    snprintf(cmd->params, sizeof(cmd->params), "%d%d", vfo, agc);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'G', 'T', CAT_CMD_SET);
+    put_digits(cmd, vfo, 1);
+    put_digits(cmd, agc, 1);
     return 0;
 }
 
 int cat_build_agc_read(cat_command_t *cmd, vfo_select_t vfo) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "GT");
-    snprintf(cmd->params, sizeof(cmd->params), "%d", vfo);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_READ;
+    set_opcode(cmd, 'G', 'T', CAT_CMD_READ);
+    put_digits(cmd, vfo, 1);
     return 0;
 }
 
 int cat_build_band_up(cat_command_t *cmd, vfo_select_t vfo) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "BU");
-    snprintf(cmd->params, sizeof(cmd->params), "%d", vfo);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'B', 'U', CAT_CMD_SET);
+    put_digits(cmd, vfo, 1);
     return 0;
 }
 
 int cat_build_band_down(cat_command_t *cmd, vfo_select_t vfo) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "BD");
-    snprintf(cmd->params, sizeof(cmd->params), "%d", vfo);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'B', 'D', CAT_CMD_SET);
+    put_digits(cmd, vfo, 1);
     return 0;
 }
 
 int cat_build_band_select(cat_command_t *cmd, vfo_select_t vfo, band_select_t band) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "BS");
-    snprintf(cmd->params, sizeof(cmd->params), "%d%02d", vfo, band);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'B', 'S', CAT_CMD_SET);
+    put_digits(cmd, vfo, 1);
+    put_digits(cmd, band, 2);
     return 0;
 }
 
 int cat_build_vfo_ab(cat_command_t *cmd) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "AB");
-    cmd->params[0] = '\0';
-    cmd->has_params = false;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'A', 'B', CAT_CMD_SET);
     return 0;
 }
 
 int cat_build_vfo_ba(cat_command_t *cmd) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "BA");
-    cmd->params[0] = '\0';
-    cmd->has_params = false;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'B', 'A', CAT_CMD_SET);
     return 0;
 }
 
 int cat_build_split_set(cat_command_t *cmd, bool enable) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "ST");
-    snprintf(cmd->params, sizeof(cmd->params), "%d", enable ? 1 : 0);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'S', 'T', CAT_CMD_SET);
+    put_digits(cmd, enable ? 1 : 0, 1);
     return 0;
 }
 
 int cat_build_split_read(cat_command_t *cmd) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "ST");
-    cmd->params[0] = '\0';
-    cmd->has_params = false;
-    cmd->type = CAT_CMD_READ;
+    set_opcode(cmd, 'S', 'T', CAT_CMD_READ);
     return 0;
 }
 
 int cat_build_ctcss_set(cat_command_t *cmd, vfo_select_t vfo, uint8_t type, uint8_t code) {
-    if (!cmd) return -1;
+    if (!cmd || type > 1) return -1;
     
-    strcpy(cmd->cmd, "CN");
-    snprintf(cmd->params, sizeof(cmd->params), "%d%d%02d", vfo, type, code);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'C', 'N', CAT_CMD_SET);
+    put_digits(cmd, vfo, 1);
+    put_digits(cmd, type, 1);
+    put_digits(cmd, code, 3);
     return 0;
 }
 
 int cat_build_ctcss_read(cat_command_t *cmd, vfo_select_t vfo) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "CN");
-    snprintf(cmd->params, sizeof(cmd->params), "%d", vfo);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_READ;
+    set_opcode(cmd, 'C', 'N', CAT_CMD_READ);
+    put_digits(cmd, vfo, 1);
     return 0;
 }
 
 int cat_build_auto_info_set(cat_command_t *cmd, bool enable) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "AI");
-    snprintf(cmd->params, sizeof(cmd->params), "%d", enable ? 1 : 0);
-    cmd->has_params = true;
-    cmd->type = CAT_CMD_SET;
+    set_opcode(cmd, 'A', 'I', CAT_CMD_SET);
+    put_digits(cmd, enable ? 1 : 0, 1);
+    return 0;
+}
+
+int cat_build_ptt_set(cat_command_t *cmd, bool transmit) {
+    if (!cmd) return -1;
+    
+    set_opcode(cmd, 'T', 'X', CAT_CMD_SET);
+    put_digits(cmd, transmit ? 1 : 0, 1);
     return 0;
 }
 
 int cat_build_firmware_version_read(cat_command_t *cmd) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "VE");
-    cmd->params[0] = '\0';
-    cmd->has_params = false;
-    cmd->type = CAT_CMD_READ;
+    set_opcode(cmd, 'V', 'E', CAT_CMD_READ);
     return 0;
 }
 
 int cat_build_radio_info_read(cat_command_t *cmd) {
     if (!cmd) return -1;
     
-    strcpy(cmd->cmd, "RI");
-    cmd->params[0] = '\0';
-    cmd->has_params = false;
-    cmd->type = CAT_CMD_READ;
+    set_opcode(cmd, 'R', 'I', CAT_CMD_READ);
     return 0;
 }
 
-/* Command Parsing Functions */
+/* Wire Encoding */
 
-int cat_parse_frequency_response(const char *response, frequency_info_t *freq_info) {
-    if (!response || !freq_info) return -1;
-    
-    if (strncmp(response, "FA", 2) == 0) {
-        freq_info->vfo = VFO_MAIN;
-        freq_info->frequency = strtoul(response + 2, NULL, 10);
-    } else if (strncmp(response, "FB", 2) == 0) {
-        freq_info->vfo = VFO_SUB;
-        freq_info->frequency = strtoul(response + 2, NULL, 10);
+/* Write the final "XXparams;" bytes. Returns the byte count, or -1 if out is too small.
+ * With CAT_WIRE_MAX bytes of room the whole params field is copied in one fixed-size
+ * move; bytes past the returned length are scratch. */
+int cat_encode_command(const cat_command_t *cmd, char *out, size_t out_size) {
+    if (!cmd || !out) return -1;
+
+    size_t len = 2 + (size_t)cmd->params_len + 1;
+    if (len > out_size) return -1;
+
+    out[0] = cmd->cmd[0];
+    out[1] = cmd->cmd[1];
+    if (out_size >= CAT_WIRE_MAX) {
+        memcpy(out + 2, cmd->params, sizeof(cmd->params));
     } else {
-        return -1;
+        for (size_t i = 0; i < cmd->params_len; ++i) {
+            out[2 + i] = cmd->params[i];
+        }
     }
-    
-    return 0;
+    out[len - 1] = ';';
+    return (int)len;
 }
 
-int cat_parse_mode_response(const char *response, mode_info_t *mode_info) {
-    if (!response || !mode_info) return -1;
-    
-    if (strncmp(response, "MD", 2) != 0) return -1;
-    
-    char *ptr;
-    int vfo_val = strtol(response + 2, &ptr, 10);
-    if (vfo_val == 0 && ptr == response + 2) return -1;
-    
-    if (vfo_val == 0) {
-        mode_info->vfo = VFO_MAIN;
-    } else if (vfo_val == 1) {
-        mode_info->vfo = VFO_SUB;
-    } else {
+/* Pack several commands back to back for a single write(). Returns total bytes or -1. */
+int cat_encode_batch(const cat_command_t *cmds, size_t count, char *out, size_t out_size) {
+    if (!cmds || !out) return -1;
+
+    size_t used = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int n = cat_encode_command(&cmds[i], out + used, out_size - used);
+        if (n < 0) return -1;
+        used += (size_t)n;
+    }
+    return (int)used;
+}
+
+/* Command Parsing Functions */
+
+/* Decoders receive the whole frame (opcode included) and its length without the ';'.
+ * The opcode has already been matched by the dispatch table. */
+typedef int (*cat_decoder_fn)(const char *frame, size_t len, void *out);
+
+/* Fixed-Width Digit Decoding */
+
+#define SWAR_ONES(x) (0x0101010101010101ULL * (uint64_t)(x))
+
+/* Eight ASCII digits, first digit in the lowest byte, validated and folded in the same pass */
+static inline int swar_decode8(uint64_t chunk, uint32_t *value) {
+    /* Every byte must be 0x30..0x39: high nibble 3, and still 3 after adding 6 */
+    uint64_t bad = ((chunk & SWAR_ONES(0xF0)) ^ SWAR_ONES(0x30)) |
+                   (((chunk + SWAR_ONES(0x06)) & SWAR_ONES(0xF0)) ^ SWAR_ONES(0x30));
+    if (bad) {
         return -1;
     }
-    
-    int mode_val = strtol(ptr, NULL, 10);
-    if (mode_val < 0 || mode_val > 99) return -1;
-    
-    mode_info->mode = (operating_mode_t)mode_val;
+
+    chunk -= SWAR_ONES('0');
+    chunk = ((chunk * 10) + (chunk >> 8)) & 0x00FF00FF00FF00FFULL;
+    chunk = ((chunk * 100) + (chunk >> 16)) & 0x0000FFFF0000FFFFULL;
+    chunk = ((chunk * 10000) + (chunk >> 32)) & 0x00000000FFFFFFFFULL;
+    *value = (uint32_t)chunk;
     return 0;
 }
 
-int cat_parse_af_gain_response(const char *response, gain_info_t *gain_info) {
-    if (!response || !gain_info) return -1;
-    
-    if (strncmp(response, "AG", 2) != 0) return -1;
-    
-    char *ptr;
-    int vfo_val = strtol(response + 2, &ptr, 10);
-    if (vfo_val == 0 && ptr == response + 2) return -1;
-    
-    if (vfo_val == 0) {
-        gain_info->vfo = VFO_MAIN;
-    } else if (vfo_val == 1) {
-        gain_info->vfo = VFO_SUB;
-    } else {
-        return -1;
+static inline uint64_t load_chunk(const char *p) {
+    uint64_t chunk;
+    memcpy(&chunk, p, sizeof(chunk));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    chunk = __builtin_bswap64(chunk);
+#endif
+    return chunk;
+}
+
+/* Decode exactly 'width' (1-9) ASCII digits. Never reads past p + width. */
+int cat_decode_digits(const char *p, size_t width, uint32_t *value) {
+    if (!p || !value || width == 0 || width > 9) return -1;
+
+    uint32_t high = 0;
+    if (width == 9) {
+        high = (uint32_t)(p[0] - '0');
+        if (high > 9) return -1;
+        p++;
+        width = 8;
     }
-    
-    int gain_val = strtol(ptr, NULL, 10);
-    if (gain_val < 0 || gain_val > 255) return -1;
-    
-    gain_info->level = (uint8_t)gain_val;
+
+    /* Short fields are left-padded with '0' so one 8-byte step covers them */
+    char padded[8] = { '0', '0', '0', '0', '0', '0', '0', '0' };
+    memcpy(padded + 8 - width, p, width);
+
+    uint32_t low;
+    if (swar_decode8(load_chunk(padded), &low) != 0) return -1;
+
+    *value = high * 100000000u + low;
     return 0;
 }
 
-int cat_parse_rf_gain_response(const char *response, gain_info_t *gain_info) {
-    if (!response || !gain_info) return -1;
-    
-    if (strncmp(response, "RG", 2) != 0) return -1;
-    
-    char *ptr;
-    int vfo_val = strtol(response + 2, &ptr, 10);
-    if (vfo_val == 0 && ptr == response + 2) return -1;
-    
-    if (vfo_val == 0) {
-        gain_info->vfo = VFO_MAIN;
-    } else if (vfo_val == 1) {
-        gain_info->vfo = VFO_SUB;
+static inline int decode_vfo(char c, vfo_select_t *vfo) {
+    if (c == '0') {
+        *vfo = VFO_MAIN;
+    } else if (c == '1') {
+        *vfo = VFO_SUB;
     } else {
         return -1;
     }
-    
-    int gain_val = strtol(ptr, NULL, 10);
-    if (gain_val < 0 || gain_val > 255) return -1;
-    
-    gain_info->level = (uint8_t)gain_val;
     return 0;
 }
 
-int cat_parse_squelch_response(const char *response, squelch_info_t *squelch_info) {
-    if (!response || !squelch_info) return -1;
-    
-    if (strncmp(response, "SQ", 2) != 0) return -1;
-    
-    char *ptr;
-    int vfo_val = strtol(response + 2, &ptr, 10);
-    if (vfo_val == 0 && ptr == response + 2) return -1;
-    
-    if (vfo_val == 0) {
-        squelch_info->vfo = VFO_MAIN;
-    } else if (vfo_val == 1) {
-        squelch_info->vfo = VFO_SUB;
+/* Answer layouts below are fixed-width; the dispatch table has already checked the length */
+
+static int decode_frequency(const char *frame, size_t len, void *out) {
+    frequency_info_t *freq_info = out;
+    uint32_t freq;
+    (void)len;
+
+    if (cat_decode_digits(frame + 2, 9, &freq) != 0) return -1;
+
+    freq_info->vfo = (frame[1] == 'A') ? VFO_MAIN : VFO_SUB;
+    freq_info->frequency = freq;
+    return 0;
+}
+
+/* MD P1 P2: P2 is a single character, '1'-'9' then 'A' for 10 and up */
+static int decode_mode(const char *frame, size_t len, void *out) {
+    mode_info_t *mode_info = out;
+    vfo_select_t vfo;
+    int mode_val;
+    (void)len;
+
+    if (decode_vfo(frame[2], &vfo) != 0) return -1;
+
+    char c = frame[3];
+    if (c >= '1' && c <= '9') {
+        mode_val = c - '0';
+    } else if (c >= 'A' && c <= 'A' + (MODE_C4FM - 10)) {
+        mode_val = c - 'A' + 10;
     } else {
         return -1;
     }
     
-    int squelch_val = strtol(ptr, NULL, 10);
-    if (squelch_val < 0 || squelch_val > 255) return -1;
-    
-    squelch_info->level = (uint8_t)squelch_val;
+    mode_info->vfo = vfo;
+    mode_info->mode = (operating_mode_t)mode_val;
     return 0;
 }
 
-int cat_parse_power_response(const char *response, power_info_t *power_info) {
-    if (!response || !power_info) return -1;
-    
-    if (strncmp(response, "PC", 2) != 0) return -1;
+/* AG, RG and SQ share the VFO + 3-digit level layout */
+static int decode_level(const char *frame, size_t len, void *out) {
+    gain_info_t *gain_info = out;
+    vfo_select_t vfo;
+    uint32_t level;
+    (void)len;
+
+    if (decode_vfo(frame[2], &vfo) != 0) return -1;
+    if (cat_decode_digits(frame + 3, 3, &level) != 0 || level > 255) return -1;
     
-    unsigned long watts = strtoul(response + 2, NULL, 10);
+    gain_info->vfo = vfo;
+    gain_info->level = (uint8_t)level;
+    return 0;
+}
+
+static int decode_power(const char *frame, size_t len, void *out) {
+    power_info_t *power_info = out;
+    uint32_t watts;
+    (void)len;
+
+    if (cat_decode_digits(frame + 2, 3, &watts) != 0) return -1;
     if (watts < 5 || watts > 100) return -1;
     
     power_info->watts = (uint8_t)watts;
     return 0;
 }
 
-int cat_parse_agc_response(const char *response, agc_info_t *agc_info) {
-    if (!response || !agc_info) return -1;
-    
-    if (strncmp(response, "GT", 2) != 0) return -1;
-    
-    char *ptr;
-    int vfo_val = strtol(response + 2, &ptr, 10);
-    if (vfo_val == 0 && ptr == response + 2) return -1;
-    
-    if (vfo_val == 0) {
-        agc_info->vfo = VFO_MAIN;
-    } else if (vfo_val == 1) {
-        agc_info->vfo = VFO_SUB;
-    } else {
-        return -1;
-    }
-    
-    int agc_val = strtol(ptr, NULL, 10);
+static int decode_agc(const char *frame, size_t len, void *out) {
+    agc_info_t *agc_info = out;
+    vfo_select_t vfo;
+    (void)len;
+
+    if (decode_vfo(frame[2], &vfo) != 0) return -1;
+
+    int agc_val = frame[3] - '0';
     if (agc_val < 0 || agc_val > 9) return -1;
     
+    agc_info->vfo = vfo;
     agc_info->agc = (agc_type_t)agc_val;
     return 0;
 }
 
-int cat_parse_split_response(const char *response, split_info_t *split_info) {
-    if (!response || !split_info) return -1;
-    
-    if (strncmp(response, "ST", 2) != 0) return -1;
-    
-    int split_val = atoi(response + 2);
-    if (split_val < 0 || split_val > 1) return -1;
+static int decode_switch(const char *frame, size_t len, void *out) {
+    bool *enabled = out;   /* split_info_t and auto_info_t hold a single bool */
+    (void)len;
+
+    if (frame[2] != '0' && frame[2] != '1') return -1;
     
-    split_info->enabled = (bool)split_val;
+    *enabled = (frame[2] == '1');
     return 0;
 }
 
-int cat_parse_ctcss_response(const char *response, ctcss_info_t *ctcss_info) {
-    if (!response || !ctcss_info) return -1;
-    
-    if (strncmp(response, "CN", 2) != 0) return -1;
-    
-    char *ptr;
-    int vfo_val = strtol(response + 2, &ptr, 10);
-    if (vfo_val == 0 && ptr == response + 2) return -1;
+/* CN P1 P2 P3: VFO, 0 CTCSS / 1 DCS, 3-digit tone or code number */
+static int decode_ctcss(const char *frame, size_t len, void *out) {
+    ctcss_info_t *ctcss_info = out;
+    vfo_select_t vfo;
+    uint32_t code;
+    (void)len;
+
+    if (decode_vfo(frame[2], &vfo) != 0) return -1;
+    if (frame[3] != '0' && frame[3] != '1') return -1;
+    if (cat_decode_digits(frame + 4, 3, &code) != 0 || code > 255) return -1;
     
-    if (vfo_val == 0) {
-        ctcss_info->vfo = VFO_MAIN;
-    } else if (vfo_val == 1) {
-        ctcss_info->vfo = VFO_SUB;
-    } else {
-        return -1;
+    ctcss_info->vfo = vfo;
+    ctcss_info->type = (uint8_t)(frame[3] - '0');
+    ctcss_info->code = (uint8_t)code;
+    return 0;
+}
+
+/* VE and RI carry free text; firmware_info_t and radio_info_t are both a 32-byte string */
+static int decode_text(const char *frame, size_t len, void *out) {
+    char *text = out;
+    size_t n = len - 2;
+
+    if (n > sizeof(((firmware_info_t *)0)->version) - 1) {
+        n = sizeof(((firmware_info_t *)0)->version) - 1;
     }
-    
-    int type_val = strtol(ptr, &ptr, 10);
-    if (type_val < 0 || type_val > 9) return -1;
-    
-    ctcss_info->type = (uint8_t)type_val;
-    
-    int code_val = strtol(ptr, NULL, 10);
-    if (code_val < 0 || code_val > 99) return -1;
-    
-    ctcss_info->code = (uint8_t)code_val;
+    memcpy(text, frame + 2, n);
+    text[n] = '\0';
+    return 0;
+}
+
+/* Opcode Table */
+
+typedef struct {
+    char opcode[3];
+    cat_response_type_t type;
+    uint8_t answer_len;     /* Full answer length including ';', 0 if variable */
+    uint8_t vfo_param;      /* 1 if P1 selects the VFO (part of the request key) */
+    cat_decoder_fn decode;  /* NULL for set-only commands */
+} cat_opcode_entry_t;
+
+static const cat_opcode_entry_t opcode_table[] = {
+    { "",   CAT_RESP_NONE,       0,  0, NULL             },  /* Slot 0: unknown opcode */
+    { "FA", CAT_RESP_FREQUENCY,  12, 0, decode_frequency },
+    { "FB", CAT_RESP_FREQUENCY,  12, 0, decode_frequency },
+    { "MD", CAT_RESP_MODE,       5,  1, decode_mode      },
+    { "AG", CAT_RESP_AF_GAIN,    7,  1, decode_level     },
+    { "RG", CAT_RESP_RF_GAIN,    7,  1, decode_level     },
+    { "SQ", CAT_RESP_SQUELCH,    7,  1, decode_level     },
+    { "PC", CAT_RESP_POWER,      6,  0, decode_power     },
+    { "GT", CAT_RESP_AGC,        5,  1, decode_agc       },
+    { "ST", CAT_RESP_SPLIT,      4,  0, decode_switch    },
+    { "CN", CAT_RESP_CTCSS,      8,  1, decode_ctcss     },
+    { "AI", CAT_RESP_AUTO_INFO,  4,  0, decode_switch    },
+    { "VE", CAT_RESP_FIRMWARE,   0,  0, decode_text      },
+    { "RI", CAT_RESP_RADIO_INFO, 0,  0, decode_text      },
+    { "AB", CAT_RESP_NONE,       0,  0, NULL             },
+    { "BA", CAT_RESP_NONE,       0,  0, NULL             },
+    { "BU", CAT_RESP_NONE,       0,  1, NULL             },
+    { "BD", CAT_RESP_NONE,       0,  1, NULL             },
+    { "BS", CAT_RESP_NONE,       0,  1, NULL             },
+};
+
+/* Direct index from the two upper-case letters to an opcode_table slot */
+#define OPCODE_SLOT(a, b) ((((a) - 'A') * 26) + ((b) - 'A'))
+
+static const uint8_t opcode_slots[26 * 26] = {
+    [OPCODE_SLOT('F', 'A')] = 1,
+    [OPCODE_SLOT('F', 'B')] = 2,
+    [OPCODE_SLOT('M', 'D')] = 3,
+    [OPCODE_SLOT('A', 'G')] = 4,
+    [OPCODE_SLOT('R', 'G')] = 5,
+    [OPCODE_SLOT('S', 'Q')] = 6,
+    [OPCODE_SLOT('P', 'C')] = 7,
+    [OPCODE_SLOT('G', 'T')] = 8,
+    [OPCODE_SLOT('S', 'T')] = 9,
+    [OPCODE_SLOT('C', 'N')] = 10,
+    [OPCODE_SLOT('A', 'I')] = 11,
+    [OPCODE_SLOT('V', 'E')] = 12,
+    [OPCODE_SLOT('R', 'I')] = 13,
+    [OPCODE_SLOT('A', 'B')] = 14,
+    [OPCODE_SLOT('B', 'A')] = 15,
+    [OPCODE_SLOT('B', 'U')] = 16,
+    [OPCODE_SLOT('B', 'D')] = 17,
+    [OPCODE_SLOT('B', 'S')] = 18,
+};
+
+uint16_t cat_opcode_key(const char *response) {
+    if (!response || !response[0]) return 0;
+    return CAT_OPCODE(response[0], response[1]);
+}
+
+static const cat_opcode_entry_t *lookup_opcode(uint16_t key) {
+    unsigned hi = (unsigned)(key >> 8) - 'A';
+    unsigned lo = (unsigned)(key & 0xFF) - 'A';
+
+    if (hi >= 26 || lo >= 26) return &opcode_table[0];
+    return &opcode_table[opcode_slots[hi * 26 + lo]];
+}
+
+/* Key pairing a read with its answer: the opcode, plus the VFO digit where P1 selects it.
+ * Works on both sides ("MD0;" and "MD02;" give the same key). 0 if unknown or too short. */
+uint32_t cat_request_key(const char *frame, size_t len) {
+    if (!frame || len < 2) return 0;
+
+    uint16_t opcode = CAT_OPCODE(frame[0], frame[1]);
+    const cat_opcode_entry_t *entry = lookup_opcode(opcode);
+    if (entry == &opcode_table[0]) return 0;
+
+    uint32_t key = (uint32_t)opcode << 8;
+    if (entry->vfo_param) {
+        if (len < 3 || frame[2] == ';') return 0;
+        key |= (uint8_t)frame[2];
+    }
+    return key;
+}
+
+/* TX (PTT) and KY (CW keying) are time-critical and go to CAT-2 when it is open */
+cat_command_class_t cat_command_class(const char *frame, size_t len) {
+    if (!frame || len < 2) return CAT_CLASS_CONTROL;
+
+    switch (CAT_OPCODE(frame[0], frame[1])) {
+        case CAT_OPCODE('T', 'X'):
+        case CAT_OPCODE('K', 'Y'):
+            return CAT_CLASS_TX;
+        default:
+            return CAT_CLASS_CONTROL;
+    }
+}
+
+/* True for a frame that asks the radio for an answer ("FA;", "MD0;"), false for sets */
+bool cat_is_read_request(const char *frame, size_t len) {
+    if (!frame || len < 2) return false;
+    if (frame[len - 1] == ';') len--;
+
+    const cat_opcode_entry_t *entry = lookup_opcode(CAT_OPCODE(frame[0], frame[1]));
+    return entry->decode && len == 2u + entry->vfo_param;
+}
+
+/* Strip the optional ';' and check the frame against its table entry */
+static const cat_opcode_entry_t *match_frame(const char *response, size_t *len) {
+    if (*len < 2) return NULL;
+    if (response[*len - 1] == ';') (*len)--;
+
+    const cat_opcode_entry_t *entry = lookup_opcode(CAT_OPCODE(response[0], response[1]));
+    if (!entry->decode) return NULL;
+    if (entry->answer_len && *len != (size_t)entry->answer_len - 1) return NULL;
+    return entry;
+}
+
+/* Decode any known answer. The frame may be a slice ending in ';' or a null-terminated string. */
+int cat_dispatch_response(const char *response, size_t len, cat_response_t *result) {
+    if (!response || !result) return -1;
+
+    result->type = CAT_RESP_NONE;
+    result->opcode = 0;
+
+    const cat_opcode_entry_t *entry = match_frame(response, &len);
+    if (!entry) return -1;
+    if (entry->decode(response, len, &result->data) != 0) return -1;
+
+    result->type = entry->type;
+    result->opcode = CAT_OPCODE(response[0], response[1]);
     return 0;
 }
 
+/* Typed entry points keep their historical contract: reject answers of another kind */
+static int parse_typed(const char *response, cat_response_type_t type, void *out) {
+    if (!response || !out) return -1;
+
+    size_t len = strlen(response);
+    const cat_opcode_entry_t *entry = match_frame(response, &len);
+    if (!entry || entry->type != type) return -1;
+    return entry->decode(response, len, out);
+}
+
+int cat_parse_frequency_response(const char *response, frequency_info_t *freq_info) {
+    return parse_typed(response, CAT_RESP_FREQUENCY, freq_info);
+}
+
+int cat_parse_mode_response(const char *response, mode_info_t *mode_info) {
+    return parse_typed(response, CAT_RESP_MODE, mode_info);
+}
+
+int cat_parse_af_gain_response(const char *response, gain_info_t *gain_info) {
+    return parse_typed(response, CAT_RESP_AF_GAIN, gain_info);
+}
+
+int cat_parse_rf_gain_response(const char *response, gain_info_t *gain_info) {
+    return parse_typed(response, CAT_RESP_RF_GAIN, gain_info);
+}
+
+int cat_parse_squelch_response(const char *response, squelch_info_t *squelch_info) {
+    return parse_typed(response, CAT_RESP_SQUELCH, squelch_info);
+}
+
+int cat_parse_power_response(const char *response, power_info_t *power_info) {
+    return parse_typed(response, CAT_RESP_POWER, power_info);
+}
+
+int cat_parse_agc_response(const char *response, agc_info_t *agc_info) {
+    return parse_typed(response, CAT_RESP_AGC, agc_info);
+}
+
+int cat_parse_split_response(const char *response, split_info_t *split_info) {
+    return parse_typed(response, CAT_RESP_SPLIT, split_info);
+}
+
+int cat_parse_ctcss_response(const char *response, ctcss_info_t *ctcss_info) {
+    return parse_typed(response, CAT_RESP_CTCSS, ctcss_info);
+}
+
 int cat_parse_firmware_version_response(const char *response, firmware_info_t *firmware_info) {
-    if (!response || !firmware_info) return -1;
-    
-    if (strncmp(response, "VE", 2) != 0) return -1;
-    
-    strncpy(firmware_info->version, response + 2, sizeof(firmware_info->version) - 1);
-    firmware_info->version[sizeof(firmware_info->version) - 1] = '\0';
-    return 0;
+    return parse_typed(response, CAT_RESP_FIRMWARE, firmware_info);
 }
 
 int cat_parse_radio_info_response(const char *response, radio_info_t *radio_info) {
-    if (!response || !radio_info) return -1;
-    
-    if (strncmp(response, "RI", 2) != 0) return -1;
-    
-    strncpy(radio_info->model, response + 2, sizeof(radio_info->model) - 1);
-    radio_info->model[sizeof(radio_info->model) - 1] = '\0';
-    return 0;
+    return parse_typed(response, CAT_RESP_RADIO_INFO, radio_info);
+}
+
+/* Utility Functions */
+
+/* Wire form of a command, null-terminated. Uses a per-thread buffer, copy it if kept. */
+const char* cat_command_to_string(const cat_command_t *cmd) {
+    static _Thread_local char wire[CAT_WIRE_MAX + 1];
+
+    int len = cat_encode_command(cmd, wire, sizeof(wire) - 1);
+    if (len < 0) return NULL;
+    wire[len] = '\0';
+    return wire;
+}
+
+const char* cat_mode_to_string(operating_mode_t mode) {
+    static const char *const names[] = {
+        [MODE_LSB] = "LSB",         [MODE_USB] = "USB",           [MODE_CW] = "CW",
+        [MODE_FM] = "FM",           [MODE_AM] = "AM",             [MODE_RTTY_LSB] = "RTTY-L",
+        [MODE_CW_R] = "CW-R",       [MODE_DATA_LSB] = "DATA-L",   [MODE_RTTY_USB] = "RTTY-U",
+        [MODE_DATA_FM] = "DATA-FM", [MODE_FM_N] = "FM-N",         [MODE_DATA_USB] = "DATA-U",
+        [MODE_AM_N] = "AM-N",       [MODE_C4FM] = "C4FM",
+    };
+
+    if (mode < MODE_LSB || mode > MODE_C4FM) return "?";
+    return names[mode];
+}
+
+const char* cat_band_to_string(band_select_t band) {
+    static const char *const names[] = {
+        "1.8MHz", "3.5MHz", "5MHz", "7MHz", "10MHz", "14MHz", "18MHz", "21MHz",
+        "24.5MHz", "28MHz", "50MHz", "70MHz/GEN", "AIR", "144MHz", "430MHz",
+    };
+
+    if (band < BAND_1_8MHZ || band > BAND_430MHZ) return "?";
+    return names[band];
+}
+
+const char* cat_agc_to_string(agc_type_t agc) {
+    static const char *const names[] = { "AUTO", "FAST", "MID", "SLOW", "OFF" };
+
+    if (agc < AGC_AUTO || agc > AGC_OFF) return "?";
+    return names[agc];
+}
+
+bool cat_is_valid_response(const char *response) {
+    if (!response) return false;
+
+    cat_response_t scratch;
+    return cat_dispatch_response(response, strlen(response), &scratch) == 0;
+}
+
+/* Expected answer length (";" included) for a command: 0 if variable or none, -1 if unknown */
+int cat_get_response_length(const char *cmd) {
+    if (!cmd || !cmd[0] || !cmd[1]) return -1;
+
+    const cat_opcode_entry_t *entry = lookup_opcode(CAT_OPCODE(cmd[0], cmd[1]));
+    if (entry == &opcode_table[0]) return -1;
+    return entry->answer_len;
 }
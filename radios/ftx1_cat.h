@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 /* CAT Command Types */
 typedef enum {
@@ -63,14 +64,24 @@ typedef enum {
     AGC_OFF = 4
 } agc_type_t;
 
+/* Port a command belongs on: CAT-1 (Enhanced) or CAT-2 (Standard, TX control) */
+typedef enum {
+    CAT_CLASS_CONTROL = 0,  /* Frequency, mode, levels, polling */
+    CAT_CLASS_TX = 1        /* PTT and CW keying, must not wait behind polling */
+} cat_command_class_t;
+
 /* CAT Command Structure */
 typedef struct {
     char cmd[3];        /* 2-character command + null terminator */
     char params[32];    /* Parameter string */
     bool has_params;    /* Whether command has parameters */
     cat_cmd_type_t type; /* Command type */
+    uint8_t params_len; /* Length of params, so encoding needs no strlen */
 } cat_command_t;
 
+/* Longest encoded command: opcode + params + ';' */
+#define CAT_WIRE_MAX (2 + 32 + 1)
+
 /* Frequency Structure */
 typedef struct {
     uint32_t frequency; /* Frequency in Hz */
@@ -145,6 +156,51 @@ typedef struct {
     char model[32];     /* Radio model string */
 } radio_info_t;
 
+/* Auto Information Structure */
+typedef struct {
+    bool enabled;
+} auto_info_t;
+
+/* Two-character opcode packed into a 16-bit key */
+#define CAT_OPCODE(a, b) ((uint16_t)(((uint8_t)(a) << 8) | (uint8_t)(b)))
+
+/* Decoded Answer Types */
+typedef enum {
+    CAT_RESP_NONE = 0,
+    CAT_RESP_FREQUENCY,
+    CAT_RESP_MODE,
+    CAT_RESP_AF_GAIN,
+    CAT_RESP_RF_GAIN,
+    CAT_RESP_SQUELCH,
+    CAT_RESP_POWER,
+    CAT_RESP_AGC,
+    CAT_RESP_SPLIT,
+    CAT_RESP_CTCSS,
+    CAT_RESP_AUTO_INFO,
+    CAT_RESP_FIRMWARE,
+    CAT_RESP_RADIO_INFO
+} cat_response_type_t;
+
+/* Typed result of cat_dispatch_response() */
+typedef struct {
+    cat_response_type_t type;
+    uint16_t opcode;    /* CAT_OPCODE() key of the answer */
+    union {
+        frequency_info_t frequency;
+        mode_info_t mode;
+        gain_info_t af_gain;
+        gain_info_t rf_gain;
+        squelch_info_t squelch;
+        power_info_t power;
+        agc_info_t agc;
+        split_info_t split;
+        ctcss_info_t ctcss;
+        auto_info_t auto_info;
+        firmware_info_t firmware;
+        radio_info_t radio;
+    } data;
+} cat_response_t;
+
 /* Function Prototypes */
 
 /* Command Building Functions */
@@ -174,6 +230,11 @@ int cat_build_ctcss_read(cat_command_t *cmd, vfo_select_t vfo);
 int cat_build_auto_info_set(cat_command_t *cmd, bool enable);
 int cat_build_firmware_version_read(cat_command_t *cmd);
 int cat_build_radio_info_read(cat_command_t *cmd);
+int cat_build_ptt_set(cat_command_t *cmd, bool transmit);
+
+/* Wire Encoding */
+int cat_encode_command(const cat_command_t *cmd, char *out, size_t out_size);
+int cat_encode_batch(const cat_command_t *cmds, size_t count, char *out, size_t out_size);
 
 /* Command Parsing Functions */
 int cat_parse_frequency_response(const char *response, frequency_info_t *freq_info);
@@ -188,6 +249,13 @@ int cat_parse_ctcss_response(const char *response, ctcss_info_t *ctcss_info);
 int cat_parse_firmware_version_response(const char *response, firmware_info_t *firmware_info);
 int cat_parse_radio_info_response(const char *response, radio_info_t *radio_info);
 
+/* Response Dispatch */
+int cat_dispatch_response(const char *response, size_t len, cat_response_t *result);
+uint16_t cat_opcode_key(const char *response);
+uint32_t cat_request_key(const char *frame, size_t len);
+bool cat_is_read_request(const char *frame, size_t len);
+cat_command_class_t cat_command_class(const char *frame, size_t len);
+
 /* Utility Functions */
 const char* cat_command_to_string(const cat_command_t *cmd);
 int cat_validate_frequency(uint32_t freq_hz, band_select_t *suggested_band);
@@ -196,5 +264,6 @@ const char* cat_band_to_string(band_select_t band);
 const char* cat_agc_to_string(agc_type_t agc);
 bool cat_is_valid_response(const char *response);
 int cat_get_response_length(const char *cmd);
+int cat_decode_digits(const char *p, size_t width, uint32_t *value);
 
 #endif /* FTX1_CAT_H */
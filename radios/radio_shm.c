@@ -0,0 +1,148 @@
+#include "radio_shm.h"
+#include "cat_framer.h"
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static int set_name(radio_shm_t *shm, const char *name) {
+    if (!name || name[0] != '/' || strlen(name) >= sizeof(shm->name) || strchr(name + 1, '/')) {
+        errno = EINVAL;
+        return -1;
+    }
+    strcpy(shm->name, name);
+    return 0;
+}
+
+/* Create (or take over) the segment; the previous owner is gone or about to be.
+ * Readers need only read access, so they can never disturb the writer. */
+int radio_shm_create(radio_shm_t *shm, const char *name) {
+    if (!shm) return -1;
+    memset(shm, 0, sizeof(*shm));
+    if (set_name(shm, name) < 0) return -1;
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+    if (ftruncate(fd, sizeof(radio_shm_segment_t)) < 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    void *base = mmap(NULL, sizeof(radio_shm_segment_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    /* Hide the segment while the header is rewritten, then start at an even seq */
+    radio_shm_segment_t *seg = base;
+    atomic_store_explicit(&seg->magic, 0, memory_order_relaxed);
+    atomic_store_explicit(&seg->seq, atomic_load_explicit(&seg->seq, memory_order_relaxed) | 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    seg->version = RADIO_SHM_VERSION;
+    seg->size = (uint16_t)sizeof(*seg);
+    seg->writer_pid = (int32_t)getpid();
+    seg->updated_ns = 0;
+    radio_state_reset(&seg->state);
+    atomic_store_explicit(&seg->seq, atomic_load_explicit(&seg->seq, memory_order_relaxed) + 1,
+                          memory_order_release);
+    atomic_store_explicit(&seg->magic, RADIO_SHM_MAGIC, memory_order_release);
+
+    shm->seg = seg;
+    shm->writer = true;
+    return 0;
+}
+
+/* Copy the whole state in; readers retry if they overlap the copy */
+void radio_shm_publish(radio_shm_t *shm, const radio_state_t *state) {
+    if (!shm || !shm->seg || !shm->writer || !state) return;
+
+    radio_shm_segment_t *seg = shm->seg;
+    uint32_t seq = atomic_load_explicit(&seg->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&seg->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);      /* seq odd before any data store */
+    seg->state = *state;
+    seg->state.dirty = 0;
+    seg->updated_ns = cat_monotonic_ns();
+    atomic_store_explicit(&seg->seq, seq + 2, memory_order_release);
+}
+
+/* Map a segment read-only. -1 with ENOENT if nobody publishes, EPROTO if the
+ * writer was built with another layout. */
+int radio_shm_open(radio_shm_t *shm, const char *name) {
+    if (!shm) return -1;
+    memset(shm, 0, sizeof(*shm));
+    if (set_name(shm, name) < 0) return -1;
+
+    int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(radio_shm_segment_t)) {
+        close(fd);
+        errno = EPROTO;
+        return -1;
+    }
+    void *base = mmap(NULL, sizeof(radio_shm_segment_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    radio_shm_segment_t *seg = base;
+    if (atomic_load_explicit(&seg->magic, memory_order_acquire) != RADIO_SHM_MAGIC ||
+        seg->version != RADIO_SHM_VERSION || seg->size != sizeof(*seg)) {
+        munmap(base, sizeof(radio_shm_segment_t));
+        errno = EPROTO;
+        return -1;
+    }
+
+    shm->seg = base;
+    return 0;
+}
+
+/* A consistent snapshot of the published state. -1 with EAGAIN if the writer
+ * stayed inside for RADIO_SHM_READ_TRIES attempts (it died mid-publication). */
+int radio_shm_read(const radio_shm_t *shm, radio_state_t *state, uint64_t *updated_ns) {
+    if (!shm || !shm->seg || !state) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    radio_shm_segment_t *seg = shm->seg;
+    for (unsigned i = 0; i < RADIO_SHM_READ_TRIES; i++) {
+        uint32_t before = atomic_load_explicit(&seg->seq, memory_order_acquire);
+        if (before & 1) {
+            sched_yield();
+            continue;
+        }
+
+        *state = seg->state;
+        uint64_t stamp = seg->updated_ns;
+        atomic_thread_fence(memory_order_acquire);  /* data loads before the second seq load */
+        if (atomic_load_explicit(&seg->seq, memory_order_relaxed) == before) {
+            if (updated_ns) *updated_ns = stamp;
+            return 0;
+        }
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+/* Publications so far: a reader polling for changes compares this first */
+uint32_t radio_shm_sequence(const radio_shm_t *shm) {
+    if (!shm || !shm->seg) return 0;
+    return atomic_load_explicit(&shm->seg->seq, memory_order_acquire) / 2;
+}
+
+/* The writer also removes the name: later readers get ENOENT, current ones keep the last state */
+void radio_shm_close(radio_shm_t *shm) {
+    if (!shm || !shm->seg) return;
+
+    munmap(shm->seg, sizeof(radio_shm_segment_t));
+    if (shm->writer) shm_unlink(shm->name);
+    memset(shm, 0, sizeof(*shm));
+}
@@ -0,0 +1,47 @@
+#ifndef RADIO_SHM_H
+#define RADIO_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "radio_state.h"
+
+/* The process that owns the port publishes its radio_state_t in a POSIX
+ * shared-memory segment; any number of local readers (panadapter, logger,
+ * scripts) copy it out without locks, syscalls or serial traffic.
+ *
+ * Single writer, sequence lock: seq is odd while the writer is inside the
+ * segment. A reader copies the state between two loads of seq and keeps the
+ * copy only if both are equal and even. */
+#define RADIO_SHM_DEFAULT_NAME  "/ftx1-state"
+#define RADIO_SHM_MAGIC         0x31585446u     /* "FTX1" */
+#define RADIO_SHM_VERSION       1
+#define RADIO_SHM_READ_TRIES    1000            /* Retries before a reader gives up (writer died inside) */
+
+typedef struct {
+    _Atomic uint32_t magic;     /* Written last at creation: readers ignore a half-made segment */
+    uint16_t version;
+    uint16_t size;              /* sizeof(radio_shm_segment_t) of the writer */
+    int32_t writer_pid;
+    _Atomic uint32_t seq;
+    uint64_t updated_ns;        /* CLOCK_MONOTONIC of the last publication */
+    radio_state_t state;        /* dirty is meaningless here */
+} radio_shm_segment_t;
+
+/* Either side of a mapping */
+typedef struct {
+    radio_shm_segment_t *seg;
+    bool writer;
+    char name[64];
+} radio_shm_t;
+
+/* Function Prototypes */
+int radio_shm_create(radio_shm_t *shm, const char *name);
+void radio_shm_publish(radio_shm_t *shm, const radio_state_t *state);
+int radio_shm_open(radio_shm_t *shm, const char *name);
+int radio_shm_read(const radio_shm_t *shm, radio_state_t *state, uint64_t *updated_ns);
+uint32_t radio_shm_sequence(const radio_shm_t *shm);
+void radio_shm_close(radio_shm_t *shm);
+
+#endif /* RADIO_SHM_H */
@@ -0,0 +1,120 @@
+#include "radio_state.h"
+#include <string.h>
+
+void radio_state_reset(radio_state_t *state) {
+    if (!state) return;
+    memset(state, 0, sizeof(*state));
+}
+
+bool radio_state_has(const radio_state_t *state, uint32_t fields) {
+    return state && (state->valid & fields) == fields;
+}
+
+/* Fields changed since the previous call; a renderer draws these once per frame */
+uint32_t radio_state_take_dirty(radio_state_t *state) {
+    if (!state) return 0;
+
+    uint32_t dirty = state->dirty;
+    state->dirty = 0;
+    return dirty;
+}
+
+/* Store a value and report its field bit if it differs or was never seen */
+#define UPDATE(dst, val, bit) do {                          \
+        if (!(state->valid & (bit)) || (dst) != (val)) {    \
+            (dst) = (val);                                  \
+            changed |= (bit);                               \
+        }                                                   \
+    } while (0)
+
+/* Apply one decoded answer. Returns the radio_field_t bits whose value changed. */
+uint32_t radio_state_apply(radio_state_t *state, const cat_response_t *resp) {
+    if (!state || !resp) return 0;
+
+    uint32_t changed = 0;
+    vfo_state_t *vfo;
+
+    switch (resp->type) {
+        case CAT_RESP_FREQUENCY:
+            vfo = &state->vfo[resp->data.frequency.vfo];
+            UPDATE(vfo->frequency, resp->data.frequency.frequency,
+                   RADIO_VFO_FIELD(RADIO_FIELD_FREQUENCY, resp->data.frequency.vfo));
+            break;
+        case CAT_RESP_MODE:
+            vfo = &state->vfo[resp->data.mode.vfo];
+            UPDATE(vfo->mode, resp->data.mode.mode,
+                   RADIO_VFO_FIELD(RADIO_FIELD_MODE, resp->data.mode.vfo));
+            break;
+        case CAT_RESP_AF_GAIN:
+            vfo = &state->vfo[resp->data.af_gain.vfo];
+            UPDATE(vfo->af_gain, resp->data.af_gain.level,
+                   RADIO_VFO_FIELD(RADIO_FIELD_AF_GAIN, resp->data.af_gain.vfo));
+            break;
+        case CAT_RESP_RF_GAIN:
+            vfo = &state->vfo[resp->data.rf_gain.vfo];
+            UPDATE(vfo->rf_gain, resp->data.rf_gain.level,
+                   RADIO_VFO_FIELD(RADIO_FIELD_RF_GAIN, resp->data.rf_gain.vfo));
+            break;
+        case CAT_RESP_SQUELCH:
+            vfo = &state->vfo[resp->data.squelch.vfo];
+            UPDATE(vfo->squelch, resp->data.squelch.level,
+                   RADIO_VFO_FIELD(RADIO_FIELD_SQUELCH, resp->data.squelch.vfo));
+            break;
+        case CAT_RESP_AGC:
+            vfo = &state->vfo[resp->data.agc.vfo];
+            UPDATE(vfo->agc, resp->data.agc.agc,
+                   RADIO_VFO_FIELD(RADIO_FIELD_AGC, resp->data.agc.vfo));
+            break;
+        case CAT_RESP_CTCSS: {
+            uint32_t bit = RADIO_VFO_FIELD(RADIO_FIELD_CTCSS, resp->data.ctcss.vfo);
+            vfo = &state->vfo[resp->data.ctcss.vfo];
+            if (!(state->valid & bit) || vfo->ctcss_type != resp->data.ctcss.type ||
+                vfo->ctcss_code != resp->data.ctcss.code) {
+                vfo->ctcss_type = resp->data.ctcss.type;
+                vfo->ctcss_code = resp->data.ctcss.code;
+                changed |= bit;
+            }
+            break;
+        }
+        case CAT_RESP_POWER:
+            UPDATE(state->power, resp->data.power.watts, RADIO_FIELD_POWER);
+            break;
+        case CAT_RESP_SPLIT:
+            UPDATE(state->split, resp->data.split.enabled, RADIO_FIELD_SPLIT);
+            break;
+        case CAT_RESP_AUTO_INFO:
+            UPDATE(state->auto_info, resp->data.auto_info.enabled, RADIO_FIELD_AUTO_INFO);
+            break;
+        case CAT_RESP_FIRMWARE:
+            if (!(state->valid & RADIO_FIELD_FIRMWARE) ||
+                strcmp(state->firmware, resp->data.firmware.version) != 0) {
+                memcpy(state->firmware, resp->data.firmware.version, sizeof(state->firmware));
+                changed |= RADIO_FIELD_FIRMWARE;
+            }
+            break;
+        case CAT_RESP_RADIO_INFO:
+            if (!(state->valid & RADIO_FIELD_RADIO_INFO) ||
+                strcmp(state->radio_info, resp->data.radio.model) != 0) {
+                memcpy(state->radio_info, resp->data.radio.model, sizeof(state->radio_info));
+                changed |= RADIO_FIELD_RADIO_INFO;
+            }
+            break;
+        default:
+            return 0;
+    }
+
+    state->valid |= changed;
+    state->dirty |= changed;
+    state->updates++;
+    return changed;
+}
+
+#undef UPDATE
+
+/* Decode a raw frame (a framer slice or a null-terminated answer) and apply it */
+uint32_t radio_state_feed(radio_state_t *state, const char *frame, size_t len) {
+    cat_response_t resp;
+
+    if (cat_dispatch_response(frame, len, &resp) != 0) return 0;
+    return radio_state_apply(state, &resp);
+}
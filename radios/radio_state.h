@@ -0,0 +1,60 @@
+#ifndef RADIO_STATE_H
+#define RADIO_STATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "ftx1_cat.h"
+
+/* Field bits. Per-VFO fields are shifted by RADIO_SUB_SHIFT for the SUB VFO. */
+typedef enum {
+    RADIO_FIELD_FREQUENCY  = 1u << 0,
+    RADIO_FIELD_MODE       = 1u << 1,
+    RADIO_FIELD_AF_GAIN    = 1u << 2,
+    RADIO_FIELD_RF_GAIN    = 1u << 3,
+    RADIO_FIELD_SQUELCH    = 1u << 4,
+    RADIO_FIELD_AGC        = 1u << 5,
+    RADIO_FIELD_CTCSS      = 1u << 6,
+    RADIO_FIELD_POWER      = 1u << 16,
+    RADIO_FIELD_SPLIT      = 1u << 17,
+    RADIO_FIELD_AUTO_INFO  = 1u << 18,
+    RADIO_FIELD_FIRMWARE   = 1u << 19,
+    RADIO_FIELD_RADIO_INFO = 1u << 20
+} radio_field_t;
+
+#define RADIO_SUB_SHIFT 8
+#define RADIO_VFO_FIELD(field, vfo) ((uint32_t)(field) << ((vfo) == VFO_SUB ? RADIO_SUB_SHIFT : 0))
+
+/* Live state of one VFO */
+typedef struct {
+    uint32_t frequency;     /* Hz */
+    operating_mode_t mode;
+    uint8_t af_gain;
+    uint8_t rf_gain;
+    uint8_t squelch;
+    agc_type_t agc;
+    uint8_t ctcss_type;     /* 0: CTCSS, 1: DCS */
+    uint8_t ctcss_code;
+} vfo_state_t;
+
+/* Whole-radio state, kept current from AI1 pushes and read answers */
+typedef struct {
+    vfo_state_t vfo[2];     /* Indexed by vfo_select_t */
+    uint8_t power;          /* Watts */
+    bool split;
+    bool auto_info;
+    char firmware[32];
+    char radio_info[32];
+    uint32_t valid;         /* radio_field_t bits received at least once */
+    uint32_t dirty;         /* radio_field_t bits changed since the last radio_state_take_dirty() */
+    uint64_t updates;       /* Answers applied */
+} radio_state_t;
+
+/* Function Prototypes */
+void radio_state_reset(radio_state_t *state);
+uint32_t radio_state_apply(radio_state_t *state, const cat_response_t *resp);
+uint32_t radio_state_feed(radio_state_t *state, const char *frame, size_t len);
+bool radio_state_has(const radio_state_t *state, uint32_t fields);
+uint32_t radio_state_take_dirty(radio_state_t *state);
+
+#endif /* RADIO_STATE_H */
@@ -4,10 +4,17 @@
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
-#include <termios.h>
 #include <errno.h>
 #include <glib.h>
 #include <sys/types.h>
+#include "radios/cat_framer.h"
+#include "serial/serial_io.h"
+#include "serial/transport.h"
+#include "radios/cat_rtt.h"
+#include "radios/cat_capture.h"
+#include "radios/cat_cache.h"
+#include "log-view.h"
+#include "serial/tx_queue.h"
 
 // Include the generated resource header
 #include "serial-terminal-resources.h"
@@ -15,6 +22,7 @@
 // Serial communication structures and functions
 typedef struct {
     int fd;
+    transport_t port;       // Owns fd: tty, or a pty/tcp/replay stand-in for the radio
     gboolean connected;
     GtkBuilder *builder;
     GtkWidget *main_window;
@@ -28,34 +36,33 @@ typedef struct {
     GtkWidget *clear_button;
     GtkWidget *bye_button;  // Add this new field
     GtkWidget *response_textview;
-    GtkTextBuffer *response_buffer;
-    guint read_source_id;
+    LogView log;                // Bounded, batched model behind response_textview
+    guint frame_tick_id;        // Pending frame-clock callback, 0 if none
+    serial_io_t io;         // Reader thread: frames the port and hands them over
+    tx_queue_t txq;         // Outgoing frames waiting for the port
+    guint write_source_id;  // G_IO_OUT watch, only while txq has a backlog
+    cat_rtt_t rtt;          // Reads in flight, paired with their answers for latency
+    guint deadline_source_id;   // One-shot timeout at the oldest unanswered read
+    guint64 deadline_at;
+    cat_capture_t capture;  // --capture: raw traffic, fd -1 when off
+    cat_cache_t cache;      // Recent answers and AI pushes; fresh ones answer reads locally
+    gboolean use_cache;
+    int baudrate;
 } AppData;
 
-// Baud rate table
-static const struct {
-    int baud;
-    speed_t constant;
-} baud_table[] = {
-    { 1200,   B1200   },
-    { 2400,   B2400   },
-    { 4800,   B4800   },
-    { 9600,   B9600   },
-    { 19200,  B19200  },
-    { 38400,  B38400  },
-    { 57600,  B57600  },
-    { 115200, B115200 },
-    { 230400, B230400 },
-    { 460800, B460800 },
-    { 921600, B921600 }
-};
-#define BAUD_TABLE_SIZE (sizeof(baud_table)/sizeof(baud_table[0]))
-
 // Function prototypes
 static void append_to_response(AppData *app_data, const char *text);
-static int init_serial(const char *device, int baudrate);
-static speed_t baud_to_constant(int baud);
-static gboolean serial_read_callback(GIOChannel *source, GIOCondition condition, gpointer data);
+static int init_serial(AppData *app_data, transport_t *t, const char *device, int baudrate);
+static void wake_main_loop(void *data);
+static gboolean drain_serial_io(gpointer data);
+static void on_frames_received(const cat_frame_t *frames, size_t count, void *data);
+static void schedule_frame_update(AppData *app_data);
+static gboolean on_frame_tick(GtkWidget *widget, GdkFrameClock *frame_clock, gpointer data);
+static gboolean serial_write_callback(GIOChannel *source, GIOCondition condition, gpointer data);
+static gboolean flush_tx_queue(AppData *app_data);
+static void show_latency(AppData *app_data, const cat_frame_t *frame, int64_t rtt_ns);
+static void arm_deadline(AppData *app_data);
+static gboolean on_deadline(gpointer data);
 static void on_command_activate(GtkEntry *entry, gpointer data);
 static gboolean is_dark_theme(void);
 static void apply_adaptive_theme(void);
@@ -67,89 +74,150 @@ void on_send_command(GtkWidget *widget, gpointer data);
 void on_clear_clicked(GtkWidget *widget, gpointer data);
 void on_bye_clicked(GtkWidget *widget, gpointer data);  // Add this line
 
-static speed_t baud_to_constant(int baud) {
-    for (size_t i = 0; i < BAUD_TABLE_SIZE; ++i) {
-        if (baud_table[i].baud == baud) {
-            return baud_table[i].constant;
-        }
-    }
-    return B38400; // fallback
+// The reader thread hands every raw read to the capture
+static void capture_rx(const char *data, size_t len, uint64_t rx_ns, void *user_data) {
+    AppData *app_data = (AppData *)user_data;
+    cat_capture_write(&app_data->capture, CAT_CAPTURE_RX, 0, rx_ns, data, len);
 }
 
-static int init_serial(const char *device, int baudrate) {
-    int fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
-    if (fd < 0) {
-        perror("open");
+// Open a serial port or a simulated one (pty:, tcp:, replay:); logs what was actually applied
+static int init_serial(AppData *app_data, transport_t *t, const char *device, int baudrate) {
+    char report[256];
+
+    if (transport_open(t, device, baudrate) < 0) {
+        perror(device);
         return -1;
     }
 
-    struct termios tty;
-    if (tcgetattr(fd, &tty) != 0) {
-        perror("tcgetattr");
-        close(fd);
-        return -1;
+    transport_describe(t, report, sizeof(report));
+    append_to_response(app_data, report);
+    return t->fd;
+}
+
+// Apply pending UI changes at most once per displayed frame
+static gboolean on_frame_tick(GtkWidget *widget, GdkFrameClock *frame_clock, gpointer data) {
+    (void)widget;  // Mark as intentionally unused
+    (void)frame_clock;
+    AppData *app_data = (AppData *)data;
+
+    app_data->frame_tick_id = 0;
+    log_view_flush(&app_data->log);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void schedule_frame_update(AppData *app_data) {
+    if (!app_data->frame_tick_id) {
+        app_data->frame_tick_id = gtk_widget_add_tick_callback(app_data->main_window, on_frame_tick, app_data, NULL);
     }
+}
 
-    cfsetospeed(&tty, baud_to_constant(baudrate));
-    cfsetispeed(&tty, baud_to_constant(baudrate));
+static void append_to_response(AppData *app_data, const char *text) {
+    // Queued with its timestamp; inserted and scrolled on the next frame
+    log_view_append(&app_data->log, NULL, text, -1);
+    schedule_frame_update(app_data);
+}
 
-    tty.c_cflag &= ~PARENB; // No parity
-    tty.c_cflag &= ~CSTOPB; // 1 stop bit
-    tty.c_cflag &= ~CSIZE;  // Clear data size bits
-    tty.c_cflag |= CS8;     // 8 data bits
-    tty.c_cflag &= ~CRTSCTS; // No hardware flow control
-    tty.c_cflag |= CREAD | CLOCAL; // Enable receiver, ignore modem control lines
+// Log an answer together with the round trip of the read that asked for it
+static void show_latency(AppData *app_data, const cat_frame_t *frame, int64_t rtt_ns) {
+    const cat_rtt_t *rtt = &app_data->rtt;
+    char line[CAT_FRAMER_MAX_FRAME + 32];
+    char status[128];
 
-    tty.c_lflag &= ~ICANON; // Non-canonical mode
-    tty.c_lflag &= ~ECHO;   // No echo
-    tty.c_lflag &= ~ECHOE;  // No echo erase
-    tty.c_lflag &= ~ISIG;   // No signal chars
+    g_snprintf(line, sizeof(line), "%.*s  (%.3f ms)", (int)frame->len, frame->data, rtt_ns / 1e6);
+    log_view_append(&app_data->log, "RECV: ", line, -1);
 
-    tty.c_iflag &= ~(IXON | IXOFF | IXANY); // No software flow control
-    tty.c_iflag &= ~(IGNBRK|BRKINT|PARMRK|ISTRIP|INLCR|IGNCR|ICRNL);
+    g_snprintf(status, sizeof(status), "RTT %.3f ms (avg %.3f, min %.3f, max %.3f) at %d baud",
+               rtt_ns / 1e6, cat_rtt_average_ns(rtt) / 1e6,
+               rtt->min_ns / 1e6, rtt->max_ns / 1e6, app_data->baudrate);
+    gtk_label_set_text(GTK_LABEL(app_data->status_label), status);
+}
 
-    tty.c_oflag &= ~OPOST; // No output processing
-    tty.c_oflag &= ~ONLCR; // No \n -> \r\n conversion
+static void on_frames_received(const cat_frame_t *frames, size_t count, void *data) {
+    AppData *app_data = (AppData *)data;
 
-    tty.c_cc[VTIME] = 1;    // Wait up to 0.1 second
-    tty.c_cc[VMIN] = 0;     // Return immediately with what we have
+    for (size_t i = 0; i < count; ++i) {
+        int64_t rtt_ns = cat_rtt_match(&app_data->rtt, frames[i].data, frames[i].len, frames[i].rx_ns);
+        // An answer to a read sent before a set of the same value must not refill the cache
+        guint64 sent_ns = rtt_ns >= 0 ? frames[i].rx_ns - (guint64)rtt_ns : 0;
+        cat_cache_store(&app_data->cache, frames[i].data, frames[i].len, frames[i].rx_ns, sent_ns);
+        if (rtt_ns >= 0) {
+            show_latency(app_data, &frames[i], rtt_ns);
+        } else {
+            log_view_append(&app_data->log, "RECV: ", frames[i].data, (gssize)frames[i].len);
+        }
+    }
+    arm_deadline(app_data);
+    schedule_frame_update(app_data);
+}
 
-    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
-        perror("tcsetattr");
-        close(fd);
-        return -1;
+// One timeout covers every read in flight: it always points at the oldest one
+static void arm_deadline(AppData *app_data) {
+    guint64 next = cat_rtt_next_deadline(&app_data->rtt, CAT_RTT_TIMEOUT_NS);
+
+    if (app_data->deadline_source_id && next == app_data->deadline_at) {
+        return;
+    }
+    if (app_data->deadline_source_id) {
+        g_source_remove(app_data->deadline_source_id);
+        app_data->deadline_source_id = 0;
+    }
+    if (next == 0) {
+        return;
     }
 
-    return fd;
+    guint64 now = cat_monotonic_ns();
+    guint delay_ms = next > now ? (guint)((next - now + 999999) / 1000000) : 0;
+    app_data->deadline_at = next;
+    app_data->deadline_source_id = g_timeout_add(delay_ms, on_deadline, app_data);
 }
 
-static void append_to_response(AppData *app_data, const char *text) {
-    GtkTextIter iter;
-    gtk_text_buffer_get_end_iter(app_data->response_buffer, &iter);
-    
-    // Add timestamp
-    GDateTime *now = g_date_time_new_now_local();
-    gchar *timestamp = g_date_time_format(now, "[%H:%M:%S] ");
-    gtk_text_buffer_insert(app_data->response_buffer, &iter, timestamp, -1);
-    g_free(timestamp);
-    g_date_time_unref(now);
-    
-    // Add the actual text
-    gtk_text_buffer_insert(app_data->response_buffer, &iter, text, -1);
-    gtk_text_buffer_insert(app_data->response_buffer, &iter, "\n", -1);
-    
-    // Auto-scroll to bottom
-    GtkTextMark *mark = gtk_text_buffer_get_insert(app_data->response_buffer);
-    gtk_text_view_scroll_mark_onscreen(GTK_TEXT_VIEW(app_data->response_textview), mark);
+// Typed commands are not resent: a missed answer is reported once and forgotten
+static gboolean on_deadline(gpointer data) {
+    AppData *app_data = (AppData *)data;
+
+    app_data->deadline_source_id = 0;
+    size_t dropped = cat_rtt_expire(&app_data->rtt, cat_monotonic_ns(), CAT_RTT_TIMEOUT_NS);
+    if (dropped) {
+        gchar *msg = g_strdup_printf("TIMEOUT: %zu command(s) unanswered after %llu ms", dropped,
+                                     (unsigned long long)(CAT_RTT_TIMEOUT_NS / 1000000));
+        append_to_response(app_data, msg);
+        g_free(msg);
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "No answer from the device");
+    }
+    arm_deadline(app_data);
+    return G_SOURCE_REMOVE;
 }
 
-static gboolean serial_read_callback(GIOChannel *source, GIOCondition condition, gpointer data) {
-    (void)source; // Mark as intentionally unused
+// Runs on the I/O thread, at most once per drain: queue the drain on the main loop
+static void wake_main_loop(void *data) {
+    g_idle_add_full(G_PRIORITY_DEFAULT, drain_serial_io, data, NULL);
+}
+
+static gboolean drain_serial_io(gpointer data) {
     AppData *app_data = (AppData *)data;
-    char buffer[256];
-    ssize_t bytes_read;
 
-    if (condition & G_IO_HUP) {
+    if (!app_data->connected) {
+        return G_SOURCE_REMOVE;
+    }
+
+    // Closed flag first: frames published just before a hangup are in this drain, not lost
+    gboolean lost = serial_io_closed(&app_data->io);
+
+    // Everything the thread framed since the last wake-up, in batches
+    serial_io_drain(&app_data->io, on_frames_received, app_data);
+
+    if (lost) {
+        serial_io_stop(&app_data->io);
+        if (app_data->write_source_id) {
+            g_source_remove(app_data->write_source_id);
+            app_data->write_source_id = 0;
+        }
+        if (app_data->deadline_source_id) {
+            g_source_remove(app_data->deadline_source_id);
+            app_data->deadline_source_id = 0;
+        }
+        transport_close(&app_data->port);
         append_to_response(app_data, "Connection lost");
         app_data->connected = FALSE;
         gtk_label_set_text(GTK_LABEL(app_data->status_label), "Disconnected");
@@ -157,28 +225,47 @@ static gboolean serial_read_callback(GIOChannel *source, GIOCondition condition,
         gtk_widget_set_sensitive(app_data->disconnect_button, FALSE);
         gtk_widget_set_sensitive(app_data->command_entry, FALSE);
         gtk_widget_set_sensitive(app_data->send_button, FALSE);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+// Push queued frames to the port; arm a G_IO_OUT watch while the kernel buffer is full
+static gboolean flush_tx_queue(AppData *app_data) {
+    if (tx_queue_flush(&app_data->txq, app_data->fd) < 0) {
+        perror("writev");
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Write error");
         return FALSE;
     }
+    cat_rtt_sent(&app_data->rtt, app_data->txq.tail, app_data->txq.last_write_ns);
+    arm_deadline(app_data);
 
-    if (condition & G_IO_IN) {
-        bytes_read = read(app_data->fd, buffer, sizeof(buffer) - 1);
-        if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-            // Remove trailing newlines for cleaner display
-            while (bytes_read > 0 && (buffer[bytes_read-1] == '\n' || buffer[bytes_read-1] == '\r')) {
-                buffer[--bytes_read] = '\0';
-            }
-            if (bytes_read > 0) {
-                gchar *recv_msg = g_strdup_printf("RECV: %s", buffer);
-                append_to_response(app_data, recv_msg);
-                g_free(recv_msg);
-            }
-        } else if (bytes_read < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-            perror("read");
-            return FALSE;
-        }
+    if (!tx_queue_empty(&app_data->txq) && !app_data->write_source_id) {
+        GIOChannel *channel = g_io_channel_unix_new(app_data->fd);
+        app_data->write_source_id = g_io_add_watch(channel, G_IO_OUT, serial_write_callback, app_data);
+        g_io_channel_unref(channel);
     }
+    return TRUE;
+}
+
+static gboolean serial_write_callback(GIOChannel *source, GIOCondition condition, gpointer data) {
+    (void)source; // Mark as intentionally unused
+    (void)condition;
+    AppData *app_data = (AppData *)data;
 
+    if (tx_queue_flush(&app_data->txq, app_data->fd) < 0) {
+        perror("writev");
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Write error");
+        app_data->write_source_id = 0;
+        return FALSE;
+    }
+    cat_rtt_sent(&app_data->rtt, app_data->txq.tail, app_data->txq.last_write_ns);
+    arm_deadline(app_data);
+
+    if (tx_queue_empty(&app_data->txq)) {
+        app_data->write_source_id = 0;
+        return FALSE;
+    }
     return TRUE;
 }
 
@@ -195,13 +282,25 @@ void on_connect_clicked(GtkWidget *widget, gpointer data) {
         return;
     }
 
-    app_data->fd = init_serial(device, baudrate);
+    app_data->fd = init_serial(app_data, &app_data->port, device, baudrate);
     if (app_data->fd < 0) {
         gtk_label_set_text(GTK_LABEL(app_data->status_label), "Failed to connect");
         return;
     }
 
+    // Reads happen on their own thread so a busy UI cannot overflow the tty buffer
+    if (serial_io_start_tapped(&app_data->io, app_data->fd, wake_main_loop, app_data,
+                               app_data->capture.fd >= 0 ? capture_rx : NULL, app_data) != 0) {
+        transport_close(&app_data->port);
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Failed to start reader thread");
+        return;
+    }
+
     app_data->connected = TRUE;
+    app_data->baudrate = baudrate;
+    tx_queue_reset(&app_data->txq);
+    cat_rtt_reset(&app_data->rtt);
+    cat_cache_init(&app_data->cache);
     gchar *status_text = g_strdup_printf("Connected to %s at %d baud", device, baudrate);
     gtk_label_set_text(GTK_LABEL(app_data->status_label), status_text);
     g_free(status_text);
@@ -211,11 +310,6 @@ void on_connect_clicked(GtkWidget *widget, gpointer data) {
     gtk_widget_set_sensitive(app_data->command_entry, TRUE);
     gtk_widget_set_sensitive(app_data->send_button, TRUE);
 
-    GIOChannel *channel = g_io_channel_unix_new(app_data->fd);
-    g_io_channel_set_encoding(channel, NULL, NULL);
-    g_io_channel_set_flags(channel, G_IO_FLAG_NONBLOCK, NULL);
-    app_data->read_source_id = g_io_add_watch(channel, G_IO_IN | G_IO_HUP, serial_read_callback, app_data);
-    g_io_channel_unref(channel);
     
     append_to_response(app_data, "Connected successfully");
 }
@@ -225,11 +319,16 @@ void on_disconnect_clicked(GtkWidget *widget, gpointer data) {
     AppData *app_data = (AppData *)data;
 
     if (app_data->connected) {
-        if (app_data->read_source_id) {
-            g_source_remove(app_data->read_source_id);
-            app_data->read_source_id = 0;
+        serial_io_stop(&app_data->io);
+        if (app_data->write_source_id) {
+            g_source_remove(app_data->write_source_id);
+            app_data->write_source_id = 0;
+        }
+        if (app_data->deadline_source_id) {
+            g_source_remove(app_data->deadline_source_id);
+            app_data->deadline_source_id = 0;
         }
-        close(app_data->fd);
+        transport_close(&app_data->port);
         app_data->connected = FALSE;
         gtk_label_set_text(GTK_LABEL(app_data->status_label), "Disconnected");
         gtk_widget_set_sensitive(app_data->connect_button, TRUE);
@@ -257,27 +356,53 @@ void on_send_command(GtkWidget *widget, gpointer data) {
     // Convert command to uppercase
     gchar *upper_command = g_ascii_strup(command, -1);
 
-    // Log the command being sent
-    gchar *sent_msg = g_strdup_printf("SENT: %s", upper_command);
-    append_to_response(app_data, sent_msg);
-    g_free(sent_msg);
-
-    // Send command
+    // A value read or pushed moments ago is answered here, without a round trip
     size_t len = strlen(upper_command);
-    if (write(app_data->fd, upper_command, len) != (ssize_t)len) {
-        perror("write");
-        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Write error");
+    const cat_cache_entry_t *cached = app_data->use_cache ?
+        cat_cache_lookup(&app_data->cache, upper_command, len, cat_monotonic_ns()) : NULL;
+    if (cached) {
+        gchar *line = g_strdup_printf("%.*s  (cache, %.0f ms old)", (int)cached->len, cached->wire,
+                                      (cat_monotonic_ns() - cached->stamp_ns) / 1e6);
+        log_view_append(&app_data->log, "RECV: ", line, -1);
+        schedule_frame_update(app_data);
+        g_free(line);
+        gtk_entry_set_text(GTK_ENTRY(app_data->command_entry), "");
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Answered from cache");
         g_free(upper_command);
         return;
     }
 
-    // Add semicolon if not present (for CAT commands)
-    if (upper_command[len - 1] != ';') {
-        write(app_data->fd, ";", 1);
+    // Queue the whole frame (command, ';' if missing, '\n') and send it in one syscall
+    struct iovec frame[3] = {
+        { .iov_base = upper_command, .iov_len = len },
+        { .iov_base = ";",           .iov_len = 1 },
+        { .iov_base = "\n",          .iov_len = 1 },
+    };
+    if (upper_command[len - 1] == ';') {
+        frame[1].iov_len = 0;
     }
-    
-    // Add newline
-    write(app_data->fd, "\n", 1);
+
+    if (tx_queue_pushv(&app_data->txq, frame, 3) != 0) {
+        gtk_label_set_text(GTK_LABEL(app_data->status_label), "Transmit queue full");
+        g_free(upper_command);
+        return;
+    }
+    if (app_data->capture.fd >= 0) {
+        cat_capture_writev(&app_data->capture, CAT_CAPTURE_TX, 0, cat_monotonic_ns(), frame, 3);
+    }
+    // Reads are timed from the writev that carries their last byte
+    cat_rtt_expect(&app_data->rtt, upper_command, len, app_data->txq.head);
+    cat_cache_invalidate(&app_data->cache, upper_command, len);
+
+    if (!flush_tx_queue(app_data)) {
+        g_free(upper_command);
+        return;
+    }
+
+    // Logged once queued: a read answered from the cache or refused above never went out
+    gchar *sent_msg = g_strdup_printf("SENT: %s", upper_command);
+    append_to_response(app_data, sent_msg);
+    g_free(sent_msg);
     
     // Clear command entry
     gtk_entry_set_text(GTK_ENTRY(app_data->command_entry), "");
@@ -296,7 +421,7 @@ static void on_command_activate(GtkEntry *entry, gpointer data) {
 void on_clear_clicked(GtkWidget *widget, gpointer data) {
     (void)widget;  // Mark as intentionally unused
     AppData *app_data = (AppData *)data;
-    gtk_text_buffer_set_text(app_data->response_buffer, "", -1);
+    log_view_clear(&app_data->log);
 }
 
 void on_bye_clicked(GtkWidget *widget, gpointer data) {
@@ -376,7 +501,24 @@ static void apply_adaptive_theme(void) {
 }
 
 int main(int argc, char *argv[]) {
-    gtk_init(&argc, &argv);
+    gint log_lines = LOG_VIEW_DEFAULT_MAX_LINES;
+    gchar *capture_path = NULL;
+    gboolean no_cache = FALSE;
+    GOptionEntry options[] = {
+        { "log-lines", 'l', 0, G_OPTION_ARG_INT, &log_lines, "Lines kept in the log view (0 = unlimited)", "N" },
+        { "capture", 'w', 0, G_OPTION_ARG_FILENAME, &capture_path, "Record all port traffic with timestamps (appends)", "FILE" },
+        { "no-cache", 0, 0, G_OPTION_ARG_NONE, &no_cache, "Send every read to the radio, even when a fresh answer is known", NULL },
+        { NULL, 0, 0, 0, NULL, NULL, NULL }
+    };
+    GError *error = NULL;
+    if (!gtk_init_with_args(&argc, &argv, NULL, options, NULL, &error)) {
+        fprintf(stderr, "%s\n", error ? error->message : "Failed to initialise GTK");
+        g_clear_error(&error);
+        return 1;
+    }
+    if (log_lines < 0) {
+        log_lines = 0;
+    }
 
     // Register the resource
     g_resources_register(serial_terminal_get_resource());
@@ -385,6 +527,13 @@ int main(int argc, char *argv[]) {
     apply_adaptive_theme();
 
     AppData app_data = {0};
+    app_data.capture.fd = -1;
+    app_data.use_cache = !no_cache;
+    if (capture_path && cat_capture_open(&app_data.capture, capture_path) < 0) {
+        fprintf(stderr, "Cannot record to %s: %s\n", capture_path,
+                errno == EINVAL ? "not a capture file" : g_strerror(errno));
+        return 1;
+    }
     app_data.builder = gtk_builder_new();
     
     // Load from resource instead of file
@@ -404,7 +553,7 @@ int main(int argc, char *argv[]) {
     app_data.clear_button = GTK_WIDGET(gtk_builder_get_object(app_data.builder, "clear_button"));
     app_data.bye_button = GTK_WIDGET(gtk_builder_get_object(app_data.builder, "bye_button"));
     app_data.response_textview = GTK_WIDGET(gtk_builder_get_object(app_data.builder, "response_textview"));
-    app_data.response_buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(app_data.response_textview));
+    log_view_init(&app_data.log, app_data.response_textview, (guint)log_lines);
 
     gtk_window_set_title(GTK_WINDOW(app_data.main_window), "CAT Test Serial Terminal");
     gtk_window_set_default_size(GTK_WINDOW(app_data.main_window), 600, 400);
@@ -423,5 +572,12 @@ int main(int argc, char *argv[]) {
 
     gtk_main();
 
+    if (app_data.connected) {
+        serial_io_stop(&app_data.io);
+        transport_close(&app_data.port);
+    }
+    log_view_free(&app_data.log);
+    cat_capture_close(&app_data.capture);
+    g_free(capture_path);
     return 0;
 }
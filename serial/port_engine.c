@@ -0,0 +1,270 @@
+#include "port_engine.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/epoll.h>
+
+enum { HANDLE_PORT, HANDLE_WATCH };
+
+#define PORT_EVENTS (EPOLLIN | EPOLLRDHUP)
+
+int port_engine_init(port_engine_t *engine, engine_frames_cb on_frames,
+                     engine_closed_cb on_closed, void *user_data) {
+    if (!engine) return -1;
+
+    memset(engine, 0, sizeof(*engine));
+    engine->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (engine->epfd < 0) return -1;
+
+    engine->on_frames = on_frames;
+    engine->on_closed = on_closed;
+    engine->user_data = user_data;
+    return 0;
+}
+
+static void collect_garbage(port_engine_t *engine) {
+    while (engine->garbage) {
+        engine_handle_t *next = engine->garbage->next_garbage;
+        free(engine->garbage);
+        engine->garbage = next;
+    }
+}
+
+/* Unregister now, free once no pending event can still point at the handle */
+static void retire(port_engine_t *engine, engine_handle_t *handle) {
+    epoll_ctl(engine->epfd, EPOLL_CTL_DEL, handle->fd, NULL);
+    handle->closed = true;
+    handle->next_garbage = engine->garbage;
+    engine->garbage = handle;
+}
+
+void port_engine_free(port_engine_t *engine) {
+    if (!engine) return;
+
+    for (size_t i = 0; i < engine->port_slots; i++) {
+        if (engine->ports[i]) port_engine_remove_port(engine, engine->ports[i]);
+    }
+    while (engine->watch_count) {
+        port_engine_remove_fd(engine, engine->watches[0]->handle.fd);
+    }
+    collect_garbage(engine);
+
+    free(engine->ports);
+    free(engine->watches);
+    if (engine->epfd >= 0) close(engine->epfd);
+    engine->epfd = -1;
+}
+
+static void capture_rx(const char *data, size_t len, uint64_t rx_ns, void *user_data) {
+    engine_port_t *port = (engine_port_t *)user_data;
+
+    cat_capture_write(port->engine->capture, CAT_CAPTURE_RX, (uint16_t)port->id, rx_ns, data, len);
+}
+
+/* Record raw reads and queued writes of every port, current and future (NULL stops) */
+void port_engine_set_capture(port_engine_t *engine, cat_capture_t *capture) {
+    if (!engine) return;
+
+    engine->capture = capture;
+    for (size_t i = 0; i < engine->port_slots; i++) {
+        if (!engine->ports[i] || !engine->ports[i]->captured) continue;
+        cat_framer_set_tap(&engine->ports[i]->framer, capture ? capture_rx : NULL, engine->ports[i]);
+    }
+}
+
+static engine_port_t *add_port(port_engine_t *engine, int fd, const char *name, bool captured) {
+    if (!engine || fd < 0) return NULL;
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) return NULL;
+
+    size_t id = 0;
+    while (id < engine->port_slots && engine->ports[id]) id++;
+    if (id == engine->port_slots) {
+        size_t slots = engine->port_slots ? engine->port_slots * 2 : 4;
+        engine_port_t **ports = realloc(engine->ports, slots * sizeof(*ports));
+        if (!ports) return NULL;
+        memset(ports + engine->port_slots, 0, (slots - engine->port_slots) * sizeof(*ports));
+        engine->ports = ports;
+        engine->port_slots = slots;
+    }
+
+    engine_port_t *port = calloc(1, sizeof(*port));
+    if (!port) return NULL;
+
+    port->handle.fd = fd;
+    port->handle.kind = HANDLE_PORT;
+    port->engine = engine;
+    port->id = (int)id;
+    strncpy(port->name, name ? name : "", sizeof(port->name) - 1);
+    cat_framer_reset(&port->framer);
+    port->captured = captured;
+    if (engine->capture && captured) cat_framer_set_tap(&port->framer, capture_rx, port);
+    tx_queue_reset(&port->txq);
+    port->events = PORT_EVENTS;
+
+    struct epoll_event ev = { .events = port->events, .data.ptr = port };
+    if (epoll_ctl(engine->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        free(port);
+        return NULL;
+    }
+
+    engine->ports[id] = port;
+    engine->port_count++;
+    return port;
+}
+
+/* Take ownership of an open port. The fd is switched to non-blocking. */
+engine_port_t *port_engine_add_port(port_engine_t *engine, int fd, const char *name) {
+    return add_port(engine, fd, name, true);
+}
+
+/* Same for a peer speaking CAT that is not a radio (a client socket): never captured */
+engine_port_t *port_engine_add_peer(port_engine_t *engine, int fd, const char *name) {
+    return add_port(engine, fd, name, false);
+}
+
+/* Unregister and close the port; queued output is discarded */
+void port_engine_remove_port(port_engine_t *engine, engine_port_t *port) {
+    if (!engine || !port || port->handle.closed) return;
+
+    engine->ports[port->id] = NULL;
+    engine->port_count--;
+    retire(engine, &port->handle);
+    close(port->handle.fd);
+}
+
+engine_port_t *port_engine_port(port_engine_t *engine, int id) {
+    if (!engine || id < 0 || (size_t)id >= engine->port_slots) return NULL;
+    return engine->ports[id];
+}
+
+/* Watch a descriptor the engine does not own (stdin, sockets) for input */
+int port_engine_add_fd(port_engine_t *engine, int fd, engine_fd_cb cb, void *user_data) {
+    if (!engine || fd < 0 || !cb) return -1;
+
+    engine_watch_t **watches = realloc(engine->watches, (engine->watch_count + 1) * sizeof(*watches));
+    if (!watches) return -1;
+    engine->watches = watches;
+
+    engine_watch_t *watch = calloc(1, sizeof(*watch));
+    if (!watch) return -1;
+
+    watch->handle.fd = fd;
+    watch->handle.kind = HANDLE_WATCH;
+    watch->cb = cb;
+    watch->user_data = user_data;
+
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = watch };
+    if (epoll_ctl(engine->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        free(watch);
+        return -1;
+    }
+
+    engine->watches[engine->watch_count++] = watch;
+    return 0;
+}
+
+/* Stop watching fd; the descriptor itself is left open */
+void port_engine_remove_fd(port_engine_t *engine, int fd) {
+    if (!engine) return;
+
+    for (size_t i = 0; i < engine->watch_count; i++) {
+        if (engine->watches[i]->handle.fd != fd) continue;
+
+        retire(engine, &engine->watches[i]->handle);
+        engine->watches[i] = engine->watches[--engine->watch_count];
+        return;
+    }
+}
+
+static void set_port_events(port_engine_t *engine, engine_port_t *port, uint32_t events) {
+    if (port->events == events) return;
+
+    struct epoll_event ev = { .events = events, .data.ptr = port };
+    if (epoll_ctl(engine->epfd, EPOLL_CTL_MOD, port->handle.fd, &ev) == 0) {
+        port->events = events;
+    }
+}
+
+/* Write what the port accepts; EPOLLOUT is armed only while a backlog remains */
+static int flush_port(port_engine_t *engine, engine_port_t *port) {
+    if (tx_queue_flush(&port->txq, port->handle.fd) < 0) return -1;
+
+    set_port_events(engine, port, tx_queue_empty(&port->txq) ? PORT_EVENTS : PORT_EVENTS | EPOLLOUT);
+    return 0;
+}
+
+/* Queue one frame and try to send it at once. -1 if the queue is full or the port failed. */
+int port_engine_sendv(port_engine_t *engine, engine_port_t *port, const struct iovec *iov, int iovcnt) {
+    if (!engine || !port || port->handle.closed) return -1;
+
+    if (tx_queue_pushv(&port->txq, iov, iovcnt) != 0) return -1;
+    if (engine->capture && port->captured) {
+        cat_capture_writev(engine->capture, CAT_CAPTURE_TX, (uint16_t)port->id, cat_monotonic_ns(), iov, iovcnt);
+    }
+    return flush_port(engine, port);
+}
+
+int port_engine_send(port_engine_t *engine, engine_port_t *port, const char *data, size_t len) {
+    struct iovec iov = { .iov_base = (void *)data, .iov_len = len };
+    return port_engine_sendv(engine, port, &iov, 1);
+}
+
+static void dispatch_frames(const cat_frame_t *frames, size_t count, void *user_data) {
+    engine_port_t *port = (engine_port_t *)user_data;
+    port_engine_t *engine = port->engine;
+
+    if (engine->on_frames && !port->handle.closed) {
+        engine->on_frames(port, frames, count, engine->user_data);
+    }
+}
+
+static void close_port(port_engine_t *engine, engine_port_t *port) {
+    if (engine->on_closed) engine->on_closed(port, engine->user_data);
+    port_engine_remove_port(engine, port);
+}
+
+static void handle_port(port_engine_t *engine, engine_port_t *port, uint32_t events) {
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP | EPOLLERR)) {
+        /* Drain first so the last answers before a hangup are not lost */
+        ssize_t n = cat_framer_read_fd(&port->framer, port->handle.fd, dispatch_frames, port);
+        if (port->handle.closed) return;
+
+        if (n < 0 || (events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR))) {
+            close_port(engine, port);
+            return;
+        }
+    }
+
+    if (events & EPOLLOUT) {
+        if (flush_port(engine, port) < 0) close_port(engine, port);
+    }
+}
+
+/* Wait up to timeout_ms (-1 forever) and handle one batch of events.
+ * Returns the number of events handled, or -1 if epoll_wait failed. */
+int port_engine_run_once(port_engine_t *engine, int timeout_ms) {
+    if (!engine) return -1;
+
+    struct epoll_event events[PORT_ENGINE_MAX_EVENTS];
+    int n = epoll_wait(engine->epfd, events, PORT_ENGINE_MAX_EVENTS, timeout_ms);
+    if (n < 0) return errno == EINTR ? 0 : -1;
+
+    for (int i = 0; i < n; i++) {
+        engine_handle_t *handle = events[i].data.ptr;
+        if (handle->closed) continue;   /* Removed by an earlier callback in this batch */
+
+        if (handle->kind == HANDLE_PORT) {
+            handle_port(engine, (engine_port_t *)handle, events[i].events);
+        } else {
+            engine_watch_t *watch = (engine_watch_t *)handle;
+            watch->cb(handle->fd, events[i].events, watch->user_data);
+        }
+    }
+
+    collect_garbage(engine);
+    return n;
+}
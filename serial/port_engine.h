@@ -0,0 +1,83 @@
+#ifndef PORT_ENGINE_H
+#define PORT_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/uio.h>
+#include "../radios/cat_framer.h"
+#include "../radios/cat_capture.h"
+#include "tx_queue.h"
+
+#define PORT_ENGINE_MAX_EVENTS 64    /* epoll events handled per wake-up */
+#define PORT_ENGINE_NAME_LEN   64
+
+typedef struct port_engine port_engine_t;
+typedef struct engine_port engine_port_t;
+
+/* Complete frames read from a port, slices valid only during the call */
+typedef void (*engine_frames_cb)(engine_port_t *port, const cat_frame_t *frames, size_t count,
+                                 void *user_data);
+/* Port hung up or failed; it is removed right after the call */
+typedef void (*engine_closed_cb)(engine_port_t *port, void *user_data);
+/* Readiness on a plain descriptor watched with port_engine_add_fd() */
+typedef void (*engine_fd_cb)(int fd, uint32_t events, void *user_data);
+
+/* Common head of everything registered with epoll */
+typedef struct engine_handle {
+    int fd;
+    int kind;
+    bool closed;            /* Removed, freed once the current event batch is done */
+    struct engine_handle *next_garbage;
+} engine_handle_t;
+
+/* One serial device: its own read framer and write queue */
+struct engine_port {
+    engine_handle_t handle;
+    port_engine_t *engine;
+    int id;                 /* Slot in engine->ports, stable while the port is open */
+    char name[PORT_ENGINE_NAME_LEN];
+    cat_framer_t framer;
+    tx_queue_t txq;
+    uint32_t events;        /* epoll events currently registered */
+    bool captured;          /* Radio side: recorded when the engine has a capture */
+    void *user_data;        /* Free for the application */
+};
+
+typedef struct {
+    engine_handle_t handle;
+    engine_fd_cb cb;
+    void *user_data;
+} engine_watch_t;
+
+/* Single-threaded epoll loop over any number of ports and extra descriptors */
+struct port_engine {
+    int epfd;
+    engine_port_t **ports;  /* Indexed by port id, NULL for free slots */
+    size_t port_slots;
+    size_t port_count;
+    engine_watch_t **watches;
+    size_t watch_count;
+    engine_handle_t *garbage;   /* Retired handles awaiting free */
+    cat_capture_t *capture;     /* Records every port's traffic when set */
+    engine_frames_cb on_frames;
+    engine_closed_cb on_closed;
+    void *user_data;
+};
+
+/* Function Prototypes */
+int port_engine_init(port_engine_t *engine, engine_frames_cb on_frames,
+                     engine_closed_cb on_closed, void *user_data);
+void port_engine_free(port_engine_t *engine);
+engine_port_t *port_engine_add_port(port_engine_t *engine, int fd, const char *name);
+engine_port_t *port_engine_add_peer(port_engine_t *engine, int fd, const char *name);
+void port_engine_remove_port(port_engine_t *engine, engine_port_t *port);
+engine_port_t *port_engine_port(port_engine_t *engine, int id);
+int port_engine_add_fd(port_engine_t *engine, int fd, engine_fd_cb cb, void *user_data);
+void port_engine_remove_fd(port_engine_t *engine, int fd);
+void port_engine_set_capture(port_engine_t *engine, cat_capture_t *capture);
+int port_engine_sendv(port_engine_t *engine, engine_port_t *port, const struct iovec *iov, int iovcnt);
+int port_engine_send(port_engine_t *engine, engine_port_t *port, const char *data, size_t len);
+int port_engine_run_once(port_engine_t *engine, int timeout_ms);
+
+#endif /* PORT_ENGINE_H */
@@ -0,0 +1,199 @@
+#define _GNU_SOURCE     /* POLLRDHUP */
+#include "serial_io.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+#define RING_MASK (SERIAL_IO_RING_SIZE - 1)
+
+typedef struct {
+    uint16_t len;
+    uint16_t reserved[3];
+    uint64_t rx_ns;
+} record_header_t;
+
+/* Records are header-aligned and never split across the ring end */
+#define RECORD_ALIGN   sizeof(record_header_t)
+#define RECORD_WRAP    0xFFFFu  /* Length marking the unused space before the ring end */
+
+static size_t record_size(size_t len) {
+    return (sizeof(record_header_t) + len + RECORD_ALIGN - 1) & ~(size_t)(RECORD_ALIGN - 1);
+}
+
+static void publish(serial_io_t *io) {
+    if (io->published == atomic_load_explicit(&io->head, memory_order_relaxed)) return;
+
+    /* Store head, then load wake_armed; the consumer does the reverse. Only
+     * seq_cst on both sides keeps both from reading the stale value (lost wake-up). */
+    atomic_store_explicit(&io->head, io->published, memory_order_seq_cst);
+    if (atomic_exchange_explicit(&io->wake_armed, 0, memory_order_seq_cst)) {
+        io->wake(io->user_data);
+    }
+}
+
+/* I/O thread: append a framer batch to the ring and make it visible in one step */
+static void store_frames(const cat_frame_t *frames, size_t count, void *user_data) {
+    serial_io_t *io = (serial_io_t *)user_data;
+    size_t tail = atomic_load_explicit(&io->tail, memory_order_acquire);
+
+    for (size_t i = 0; i < count; i++) {
+        size_t need = record_size(frames[i].len);
+        size_t offset = io->published & RING_MASK;
+        size_t to_end = SERIAL_IO_RING_SIZE - offset;
+        size_t wrap = need > to_end ? to_end : 0;
+
+        if (io->published + wrap + need - tail > SERIAL_IO_RING_SIZE) {
+            tail = atomic_load_explicit(&io->tail, memory_order_acquire);
+            if (io->published + wrap + need - tail > SERIAL_IO_RING_SIZE) {
+                atomic_fetch_add_explicit(&io->overflows, 1, memory_order_relaxed);
+                continue;
+            }
+        }
+
+        if (wrap) {
+            ((record_header_t *)(io->ring + offset))->len = RECORD_WRAP;
+            io->published += wrap;
+            offset = 0;
+        }
+
+        record_header_t *rec = (record_header_t *)(io->ring + offset);
+        rec->len = (uint16_t)frames[i].len;
+        rec->rx_ns = frames[i].rx_ns;
+        memcpy(rec + 1, frames[i].data, frames[i].len);
+        io->published += need;
+    }
+    publish(io);
+}
+
+static void *io_thread(void *arg) {
+    serial_io_t *io = (serial_io_t *)arg;
+    /* A socket peer closing (tcp:, end of a replay) only shows as POLLRDHUP
+     * and zero-byte reads, never POLLHUP, as with EPOLLRDHUP in port_engine */
+    struct pollfd fds[2] = {
+        { .fd = io->fd,      .events = POLLIN | POLLRDHUP },
+        { .fd = io->stop_fd, .events = POLLIN },
+    };
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents) break;
+
+        /* Drain first so the last answers before a hangup are not lost */
+        if (fds[0].revents & (POLLIN | POLLRDHUP)) {
+            ssize_t n = cat_framer_read_fd(&io->framer, io->fd, store_frames, io);
+            if (n < 0) break;
+        }
+        if (fds[0].revents & (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL)) break;
+    }
+
+    /* Hangup or error: let the consumer notice even if it is not waiting on frames */
+    atomic_store_explicit(&io->closed, true, memory_order_seq_cst);
+    if (atomic_exchange_explicit(&io->wake_armed, 0, memory_order_seq_cst)) {
+        io->wake(io->user_data);
+    }
+    return NULL;
+}
+
+int serial_io_start(serial_io_t *io, int fd, serial_io_wake_fn wake, void *user_data) {
+    return serial_io_start_tapped(io, fd, wake, user_data, NULL, NULL);
+}
+
+/* Same, and every raw read is also handed to tap, on the I/O thread */
+int serial_io_start_tapped(serial_io_t *io, int fd, serial_io_wake_fn wake, void *user_data,
+                           cat_framer_tap_fn tap, void *tap_data) {
+    if (!io || fd < 0 || !wake) return -1;
+
+    memset(io, 0, sizeof(*io));
+    io->ring = malloc(SERIAL_IO_RING_SIZE);
+    if (!io->ring) return -1;
+
+    io->stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (io->stop_fd < 0) {
+        free(io->ring);
+        io->ring = NULL;
+        return -1;
+    }
+
+    io->fd = fd;
+    io->wake = wake;
+    io->user_data = user_data;
+    cat_framer_reset(&io->framer);
+    cat_framer_set_tap(&io->framer, tap, tap_data);
+    atomic_store(&io->wake_armed, 1);
+
+    if (pthread_create(&io->thread, NULL, io_thread, io) != 0) {
+        close(io->stop_fd);
+        free(io->ring);
+        io->ring = NULL;
+        return -1;
+    }
+    io->running = true;
+    return 0;
+}
+
+/* Join the thread; the fd itself is left open for the caller to close */
+void serial_io_stop(serial_io_t *io) {
+    if (!io || !io->running) return;
+
+    uint64_t one = 1;
+    if (write(io->stop_fd, &one, sizeof(one)) < 0) {
+        /* An eventfd write only fails on counter overflow, the thread is woken anyway */
+    }
+    pthread_join(io->thread, NULL);
+
+    close(io->stop_fd);
+    free(io->ring);
+    io->ring = NULL;
+    io->running = false;
+}
+
+/* Main loop side: hand everything queued to cb in zero-copy batches, then re-arm the wake-up */
+size_t serial_io_drain(serial_io_t *io, cat_frame_batch_cb cb, void *user_data) {
+    if (!io || !io->ring) return 0;
+
+    cat_frame_t batch[CAT_FRAMER_BATCH];
+    size_t total = 0;
+
+    /* Arm before reading head so frames published meanwhile trigger a new wake-up */
+    atomic_store_explicit(&io->wake_armed, 1, memory_order_seq_cst);
+
+    size_t tail = atomic_load_explicit(&io->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&io->head, memory_order_seq_cst);   /* pairs with publish() */
+
+    while (tail != head) {
+        size_t count = 0;
+        size_t next = tail;
+
+        while (next != head && count < CAT_FRAMER_BATCH) {
+            const record_header_t *rec = (const record_header_t *)(io->ring + (next & RING_MASK));
+            if (rec->len == RECORD_WRAP) {
+                next += SERIAL_IO_RING_SIZE - (next & RING_MASK);
+                continue;
+            }
+            batch[count].data = (const char *)(rec + 1);
+            batch[count].len = rec->len;
+            batch[count].rx_ns = rec->rx_ns;
+            count++;
+            next += record_size(rec->len);
+        }
+
+        if (count && cb) cb(batch, count, user_data);
+        total += count;
+
+        /* Space is only released after the callback is done with the slices */
+        tail = next;
+        atomic_store_explicit(&io->tail, tail, memory_order_release);
+    }
+    return total;
+}
+
+/* Load it before serial_io_drain(): once true, that drain sees every frame the thread published */
+bool serial_io_closed(serial_io_t *io) {
+    return io && atomic_load_explicit(&io->closed, memory_order_seq_cst);
+}
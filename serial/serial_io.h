@@ -0,0 +1,46 @@
+#ifndef SERIAL_IO_H
+#define SERIAL_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "../radios/cat_framer.h"
+
+/* Ring size must be a power of two: about 10 s of back-to-back short frames at 921600 baud */
+#define SERIAL_IO_RING_SIZE (1u << 20)
+
+/* Called from the I/O thread when frames become available and the consumer is idle.
+ * Must be thread-safe (e.g. g_idle_add), it fires at most once per serial_io_drain(). */
+typedef void (*serial_io_wake_fn)(void *user_data);
+
+/* Reader thread for one port. The thread owns the fd's read side and the framer;
+ * complete frames are copied into a single-producer/single-consumer ring that
+ * the main loop drains. Writes stay with the caller. */
+typedef struct {
+    int fd;
+    int stop_fd;                /* eventfd that interrupts poll() on stop */
+    pthread_t thread;
+    bool running;
+    cat_framer_t framer;        /* Touched by the I/O thread only */
+    char *ring;
+    _Atomic size_t head;        /* Producer position (monotonic) */
+    _Atomic size_t tail;        /* Consumer position (monotonic) */
+    size_t published;           /* Producer-private head not yet made visible */
+    atomic_int wake_armed;      /* Consumer waits for a wake-up */
+    atomic_bool closed;         /* Port hung up or failed */
+    _Atomic uint64_t overflows; /* Frames lost because the consumer stalled for too long */
+    serial_io_wake_fn wake;
+    void *user_data;
+} serial_io_t;
+
+/* Function Prototypes */
+int serial_io_start(serial_io_t *io, int fd, serial_io_wake_fn wake, void *user_data);
+int serial_io_start_tapped(serial_io_t *io, int fd, serial_io_wake_fn wake, void *user_data,
+                           cat_framer_tap_fn tap, void *tap_data);
+void serial_io_stop(serial_io_t *io);
+size_t serial_io_drain(serial_io_t *io, cat_frame_batch_cb cb, void *user_data);
+bool serial_io_closed(serial_io_t *io);
+
+#endif /* SERIAL_IO_H */
@@ -0,0 +1,199 @@
+/* termios2 lives in the kernel headers, which clash with glibc's <termios.h>:
+ * this file uses the ioctls directly and includes nothing termios-related besides. */
+#include "serial_port.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <libgen.h>
+#include <limits.h>
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+#include <linux/serial.h>
+
+/* Rates with a Bnnn constant; anything else needs BOTHER */
+static const struct {
+    unsigned baud;
+    unsigned constant;
+} standard_rates[] = {
+    { 1200,   B1200   },
+    { 2400,   B2400   },
+    { 4800,   B4800   },
+    { 9600,   B9600   },
+    { 19200,  B19200  },
+    { 38400,  B38400  },
+    { 57600,  B57600  },
+    { 115200, B115200 },
+    { 230400, B230400 },
+    { 460800, B460800 },
+    { 921600, B921600 }
+};
+#define STANDARD_RATE_COUNT (sizeof(standard_rates)/sizeof(standard_rates[0]))
+
+#define MAX_FRAME_BYTES 128     /* Longest CAT answer a blocking read waits for */
+
+void serial_port_config_default(serial_port_config_t *cfg, int baud) {
+    if (!cfg) return;
+
+    cfg->baud = baud > 0 ? baud : SERIAL_PORT_DEFAULT_BAUD;
+    cfg->blocking = false;
+    cfg->low_latency = true;
+}
+
+/* Rates with a termios constant, for listings; 0 past the end */
+int serial_port_standard_rate(size_t index) {
+    return index < STANDARD_RATE_COUNT ? (int)standard_rates[index].baud : 0;
+}
+
+static unsigned standard_constant(unsigned baud) {
+    for (size_t i = 0; i < STANDARD_RATE_COUNT; i++) {
+        if (standard_rates[i].baud == baud) return standard_rates[i].constant;
+    }
+    return 0;
+}
+
+/* Non-blocking ports are driven by poll(): read() must never wait (0/0).
+ * Blocking ports return on the first byte (VMIN 0) and give up after the time
+ * the longest frame takes on the wire, so slow links do not time out mid-answer. */
+static void pick_vmin_vtime(const serial_port_config_t *cfg, uint8_t *vmin, uint8_t *vtime) {
+    *vmin = 0;
+    *vtime = 0;
+    if (!cfg->blocking) return;
+
+    unsigned ds = (unsigned)((MAX_FRAME_BYTES * 10ull * 10 + (unsigned)cfg->baud - 1) / (unsigned)cfg->baud);
+    if (ds < 1) ds = 1;
+    if (ds > 255) ds = 255;
+    *vtime = (uint8_t)ds;
+}
+
+static int set_low_latency(int fd, bool enable) {
+    struct serial_struct ss;
+    if (ioctl(fd, TIOCGSERIAL, &ss) < 0) return -1;
+
+    if (enable) ss.flags |= ASYNC_LOW_LATENCY;
+    else ss.flags &= ~ASYNC_LOW_LATENCY;
+    ioctl(fd, TIOCSSERIAL, &ss);    /* Some drivers refuse, the read-back tells */
+
+    if (ioctl(fd, TIOCGSERIAL, &ss) < 0) return -1;
+    return (ss.flags & ASYNC_LOW_LATENCY) ? 1 : 0;
+}
+
+/* FTDI and similar bridges buffer up to latency_timer ms before sending a USB packet */
+static int read_latency_timer(const char *device) {
+    char real[PATH_MAX];
+    if (!realpath(device, real)) return -1;
+
+    char path[PATH_MAX + 64];
+    snprintf(path, sizeof(path), "/sys/class/tty/%s/device/latency_timer", basename(real));
+
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int ms = -1;
+    if (fscanf(f, "%d", &ms) != 1) ms = -1;
+    fclose(f);
+    return ms;
+}
+
+/* Open and configure device. Returns the fd (non-blocking unless cfg->blocking), or -1 with errno set.
+ * info, if given, is filled from what the kernel reports after configuration. */
+int serial_port_open(const char *device, const serial_port_config_t *cfg, serial_port_info_t *info) {
+    serial_port_config_t defaults;
+    if (!device) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!cfg) {
+        serial_port_config_default(&defaults, SERIAL_PORT_DEFAULT_BAUD);
+        cfg = &defaults;
+    }
+    if (cfg->baud <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) < 0) goto fail;
+
+    /* 8N1 raw, receiver on, modem lines ignored */
+    tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS | CBAUD | (CBAUD << IBSHIFT));
+    tio.c_cflag |= CS8 | CREAD | CLOCAL;
+    tio.c_lflag &= ~(ICANON | ECHO | ECHOE | ECHONL | ISIG | IEXTEN);
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY | IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL);
+    tio.c_oflag &= ~(OPOST | ONLCR);
+
+    unsigned constant = standard_constant((unsigned)cfg->baud);
+    if (constant) {
+        tio.c_cflag |= constant | (constant << IBSHIFT);
+    } else {
+        tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    }
+    tio.c_ispeed = (unsigned)cfg->baud;
+    tio.c_ospeed = (unsigned)cfg->baud;
+
+    uint8_t vmin, vtime;
+    pick_vmin_vtime(cfg, &vmin, &vtime);
+    tio.c_cc[VMIN] = vmin;
+    tio.c_cc[VTIME] = vtime;
+
+    if (ioctl(fd, TCSETS2, &tio) < 0) goto fail;
+
+    int low_latency = set_low_latency(fd, cfg->low_latency);
+    ioctl(fd, TCFLSH, TCIOFLUSH);
+
+    if (cfg->blocking) {
+        int flags = fcntl(fd, F_GETFL);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) < 0) goto fail;
+    }
+
+    if (info) {
+        struct termios2 applied;
+        if (ioctl(fd, TCGETS2, &applied) < 0) goto fail;
+
+        memset(info, 0, sizeof(*info));
+        info->requested_baud = cfg->baud;
+        info->ispeed = applied.c_ispeed;
+        info->ospeed = applied.c_ospeed;
+        info->custom_rate = (applied.c_cflag & CBAUD) == BOTHER;
+        info->low_latency = low_latency;
+        info->latency_timer_ms = read_latency_timer(device);
+        info->vmin = applied.c_cc[VMIN];
+        info->vtime = applied.c_cc[VTIME];
+    }
+    return fd;
+
+fail:;
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return -1;
+}
+
+/* The UART divisor rarely hits the rate exactly; beyond 2% the far end misreads bytes */
+bool serial_port_rate_exact(const serial_port_info_t *info) {
+    if (!info || info->requested_baud <= 0) return false;
+
+    long diff = (long)info->ospeed - info->requested_baud;
+    if (diff < 0) diff = -diff;
+    return diff * 50 <= info->requested_baud;
+}
+
+/* One line for logs: rates, low latency, latency timer, VMIN/VTIME */
+int serial_port_describe(const serial_port_info_t *info, char *buf, size_t size) {
+    if (!info || !buf || size == 0) return -1;
+
+    char timer[32] = "n/a";
+    if (info->latency_timer_ms >= 0) snprintf(timer, sizeof(timer), "%d ms", info->latency_timer_ms);
+
+    int n = snprintf(buf, size, "%u/%u baud%s%s, low latency %s, latency timer %s, VMIN %u VTIME %u",
+                     info->ispeed, info->ospeed,
+                     info->custom_rate ? " (BOTHER)" : "",
+                     serial_port_rate_exact(info) ? "" : " NOT the requested rate",
+                     info->low_latency > 0 ? "on" : info->low_latency == 0 ? "off" : "unsupported",
+                     timer, info->vmin, info->vtime);
+    return n < 0 ? -1 : 0;
+}
@@ -0,0 +1,36 @@
+#ifndef SERIAL_PORT_H
+#define SERIAL_PORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SERIAL_PORT_DEFAULT_BAUD 38400
+
+/* How to open a port: 8N1, raw, no flow control, any baud rate */
+typedef struct {
+    int baud;               /* Standard or arbitrary rate (termios2 BOTHER) */
+    bool blocking;          /* Keep blocking reads; VMIN/VTIME then bound each read() */
+    bool low_latency;       /* Ask the driver for ASYNC_LOW_LATENCY */
+} serial_port_config_t;
+
+/* What the kernel actually applied, read back after configuration */
+typedef struct {
+    int requested_baud;
+    unsigned ispeed;        /* Effective input rate */
+    unsigned ospeed;        /* Effective output rate */
+    bool custom_rate;       /* Set through BOTHER, not a Bnnn constant */
+    int low_latency;        /* 1 on, 0 off, -1 not supported by the driver */
+    int latency_timer_ms;   /* USB-UART latency timer from sysfs, -1 if the device has none */
+    uint8_t vmin;
+    uint8_t vtime;          /* Deciseconds */
+} serial_port_info_t;
+
+/* Function Prototypes */
+void serial_port_config_default(serial_port_config_t *cfg, int baud);
+int serial_port_open(const char *device, const serial_port_config_t *cfg, serial_port_info_t *info);
+bool serial_port_rate_exact(const serial_port_info_t *info);
+int serial_port_standard_rate(size_t index);
+int serial_port_describe(const serial_port_info_t *info, char *buf, size_t size);
+
+#endif /* SERIAL_PORT_H */
@@ -0,0 +1,372 @@
+#define _GNU_SOURCE     /* ptsname_r, pipe2 */
+#include "transport.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define REPLAY_CHUNK 4096
+
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0) return -1;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+const char *transport_kind_name(transport_kind_t kind) {
+    switch (kind) {
+        case TRANSPORT_TTY:    return "tty";
+        case TRANSPORT_PTY:    return "pty";
+        case TRANSPORT_TCP:    return "tcp";
+        case TRANSPORT_REPLAY: return "replay";
+    }
+    return "?";
+}
+
+static int open_tty(transport_t *t, const char *device) {
+    serial_port_config_t config;
+
+    serial_port_config_default(&config, t->baud);
+    t->fd = serial_port_open(device, &config, &t->port);
+    snprintf(t->name, sizeof(t->name), "%s", device);
+    return t->fd < 0 ? -1 : 0;
+}
+
+/* The program keeps the master; the slave stays open so writes never hit a hung-up
+ * line before a peer attaches. link, if given, is pointed at the slave for the peer. */
+static int open_pty(transport_t *t, const char *link) {
+    t->fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (t->fd < 0) return -1;
+    if (grantpt(t->fd) < 0 || unlockpt(t->fd) < 0 || ptsname_r(t->fd, t->name, sizeof(t->name)) != 0) {
+        return -1;
+    }
+
+    /* The slave is the radio's end: raw, no echo, like a real CAT port */
+    t->peer_fd = open(t->name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (t->peer_fd < 0) return -1;
+    serial_port_config_t config;
+    serial_port_config_default(&config, t->baud);
+    config.low_latency = false;
+    int raw = serial_port_open(t->name, &config, NULL);
+    if (raw >= 0) close(raw);
+
+    if (link && *link) {
+        unlink(link);
+        if (symlink(t->name, link) < 0) return -1;
+        snprintf(t->link, sizeof(t->link), "%s", link);
+    }
+    return 0;
+}
+
+/* "port" or "host:port"; the host defaults to the loopback */
+static int open_tcp(transport_t *t, const char *address) {
+    char host[TRANSPORT_NAME_LEN] = "127.0.0.1";
+    const char *port = address;
+    const char *colon = strrchr(address, ':');
+    if (colon) {
+        size_t n = (size_t)(colon - address);
+        if (n >= sizeof(host)) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        if (n) {
+            memcpy(host, address, n);
+            host[n] = '\0';
+        }
+        port = colon + 1;
+    }
+
+    /* Named up front: an address too long for the logs is refused before connecting */
+    int named = snprintf(t->name, sizeof(t->name), "%s:%s", host, port);
+    if (named < 0 || (size_t)named >= sizeof(t->name)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(host, port, &hints, &res) != 0) {
+        errno = EHOSTUNREACH;
+        return -1;
+    }
+
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        t->fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (t->fd < 0) continue;
+        if (connect(t->fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        close(t->fd);
+        t->fd = -1;
+    }
+    freeaddrinfo(res);
+    if (t->fd < 0) return -1;
+
+    /* CAT frames are a few bytes each: send them at once rather than coalesce */
+    int one = 1;
+    setsockopt(t->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return set_nonblocking(t->fd);
+}
+
+static uint64_t replay_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Wait on the program's side, swallowing whatever it sends.
+ * 1 if it can take more bytes, 0 if not (yet), -1 once the replay must stop. */
+static int replay_poll(transport_t *t, bool want_write, int timeout) {
+    struct pollfd fds[2] = {
+        { .fd = t->peer_fd, .events = POLLIN | (want_write ? POLLOUT : 0) },
+        { .fd = t->stop_fd, .events = POLLIN },
+    };
+    if (poll(fds, 2, timeout) < 0) return errno == EINTR ? 0 : -1;
+    if (fds[1].revents) return -1;
+
+    if (fds[0].revents & POLLIN) {
+        char sink[512];
+        ssize_t n = read(t->peer_fd, sink, sizeof(sink));
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) return -1;
+    }
+    if (fds[0].revents & (POLLHUP | POLLERR)) return -1;
+    return (fds[0].revents & POLLOUT) ? 1 : 0;
+}
+
+/* Hand out up to len bytes; returns how many went, -1 once the replay must stop */
+static ssize_t replay_write(transport_t *t, const char *data, size_t len) {
+    ssize_t n = write(t->peer_fd, data, len);
+    if (n < 0) return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    return n;
+}
+
+/* Raw recordings: fed to the program at line pace.
+ * At the end of the file the write side is shut down: the program's side
+ * then polls with (E)POLLRDHUP and reads 0 bytes, and must treat that as a hangup. */
+static void *replay_thread(void *arg) {
+    transport_t *t = (transport_t *)arg;
+    char buf[REPLAY_CHUNK];
+    size_t buf_len = 0, buf_off = 0;
+    bool eof = false;
+    uint64_t start = replay_now_ns();
+    uint64_t sent = 0;
+
+    for (;;) {
+        if (!eof && buf_off == buf_len) {
+            ssize_t n = read(t->replay_fd, buf, sizeof(buf));
+            if (n <= 0) {
+                eof = true;
+                shutdown(t->peer_fd, SHUT_WR);
+            } else {
+                buf_len = (size_t)n;
+                buf_off = 0;
+            }
+        }
+
+        /* Bytes the line would have delivered by now (10 bits each) */
+        size_t allowed = buf_len - buf_off;
+        if (!eof && t->baud > 0) {
+            uint64_t due = (replay_now_ns() - start) * (uint64_t)t->baud / 10 / 1000000000ull;
+            allowed = due > sent ? (size_t)(due - sent) : 0;
+            if (allowed > buf_len - buf_off) allowed = buf_len - buf_off;
+        }
+
+        int timeout = (!eof && !allowed) ? 1 : -1;     /* Paced: wait for the next byte's slot */
+        int rc = replay_poll(t, allowed > 0, timeout);
+        if (rc < 0) break;
+        if (rc > 0 && allowed) {
+            ssize_t n = replay_write(t, buf + buf_off, allowed);
+            if (n < 0) break;
+            buf_off += (size_t)n;
+            sent += (uint64_t)n;
+        }
+    }
+    return NULL;
+}
+
+/* Captures (radios/cat_capture.h): RX chunks go out with their recorded spacing,
+ * or back to back when unpaced; TX records are skipped. */
+static void *capture_thread(void *arg) {
+    transport_t *t = (transport_t *)arg;
+    cat_capture_record_t rec = { 0 };
+    const char *data = NULL;
+    size_t off = 0;
+    bool eof = false, started = false;
+    uint64_t start = replay_now_ns(), first_ns = 0;
+
+    for (;;) {
+        if (!eof && off == rec.len) {
+            int rc;
+            while ((rc = cat_capture_next(&t->capture, &rec, &data)) == 1 && rec.dir != CAT_CAPTURE_RX)
+                ;
+            if (rc != 1) {
+                eof = true;
+                rec.len = 0;
+                shutdown(t->peer_fd, SHUT_WR);
+            } else if (!started) {
+                first_ns = rec.t_ns;
+                started = true;
+            }
+            off = 0;
+        }
+
+        bool ready = off < rec.len;
+        int timeout = -1;
+        if (ready && t->baud > 0) {
+            uint64_t due = start + (rec.t_ns - first_ns);
+            uint64_t now = replay_now_ns();
+            if (due > now) {
+                ready = false;
+                timeout = (int)((due - now + 999999) / 1000000);
+            }
+        }
+
+        int rc = replay_poll(t, ready, timeout);
+        if (rc < 0) break;
+        if (rc > 0 && ready) {
+            ssize_t n = replay_write(t, data + off, rec.len - off);
+            if (n < 0) break;
+            off += (size_t)n;
+        }
+    }
+    return NULL;
+}
+
+static int open_replay(transport_t *t, const char *path) {
+    snprintf(t->name, sizeof(t->name), "%s", path);
+    t->replay_fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (t->replay_fd < 0) return -1;
+
+    t->is_capture = cat_capture_is_capture(t->replay_fd);
+    if (t->is_capture && cat_capture_map(&t->capture, path) < 0) return -1;
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0) return -1;
+    t->fd = sv[0];
+    t->peer_fd = sv[1];
+    if (set_nonblocking(t->fd) < 0 || set_nonblocking(t->peer_fd) < 0) return -1;
+
+    t->stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (t->stop_fd < 0) return -1;
+    if (pthread_create(&t->thread, NULL, t->is_capture ? capture_thread : replay_thread, t) != 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+    t->running = true;
+    return 0;
+}
+
+/* Open the backend named by spec (see transport_kind_t). baud applies to ttys
+ * and paces replays (line rate for raw files, recorded spacing for captures);
+ * 0 replays as fast as the reader takes it.
+ * Returns 0 with t->fd ready, or -1 with errno set and t closed. */
+int transport_open(transport_t *t, const char *spec, int baud) {
+    if (!t || !spec) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(t, 0, sizeof(*t));
+    t->fd = -1;
+    t->peer_fd = -1;
+    t->replay_fd = -1;
+    t->stop_fd = -1;
+    t->baud = baud;
+
+    int rc;
+    if (strncmp(spec, "pty:", 4) == 0) {
+        t->kind = TRANSPORT_PTY;
+        rc = open_pty(t, spec + 4);
+    } else if (strncmp(spec, "tcp:", 4) == 0) {
+        t->kind = TRANSPORT_TCP;
+        rc = open_tcp(t, spec + 4);
+    } else if (strncmp(spec, "replay:", 7) == 0) {
+        t->kind = TRANSPORT_REPLAY;
+        rc = open_replay(t, spec + 7);
+    } else {
+        t->kind = TRANSPORT_TTY;
+        rc = open_tty(t, strncmp(spec, "tty:", 4) == 0 ? spec + 4 : spec);
+    }
+
+    if (rc < 0) {
+        int saved = errno;
+        transport_close(t);
+        errno = saved;
+        return -1;
+    }
+    return 0;
+}
+
+/* Hand the fd to an owner that closes it itself (port_engine). The rest of the
+ * transport (PTY slave, replay feeder) still needs transport_close() later. */
+int transport_release_fd(transport_t *t) {
+    if (!t) return -1;
+
+    int fd = t->fd;
+    t->fd = -1;
+    return fd;
+}
+
+void transport_close(transport_t *t) {
+    if (!t) return;
+
+    if (t->fd >= 0) close(t->fd);
+    t->fd = -1;
+
+    if (t->running) {
+        uint64_t one = 1;
+        ssize_t n = write(t->stop_fd, &one, sizeof(one));
+        (void)n;
+        pthread_join(t->thread, NULL);
+        t->running = false;
+    }
+    if (t->stop_fd >= 0) close(t->stop_fd);
+    if (t->replay_fd >= 0) close(t->replay_fd);
+    if (t->peer_fd >= 0) close(t->peer_fd);
+    t->stop_fd = t->replay_fd = t->peer_fd = -1;
+    cat_capture_unmap(&t->capture);
+
+    if (t->link[0]) {
+        unlink(t->link);
+        t->link[0] = '\0';
+    }
+}
+
+/* One line for logs: backend, endpoint and, for ttys, what the kernel applied */
+int transport_describe(const transport_t *t, char *buf, size_t size) {
+    if (!t || !buf || size == 0) return -1;
+
+    int n;
+    switch (t->kind) {
+        case TRANSPORT_TTY: {
+            char port[160];
+            serial_port_describe(&t->port, port, sizeof(port));
+            n = snprintf(buf, size, "%s: %s", t->name, port);
+            break;
+        }
+        case TRANSPORT_PTY:
+            n = snprintf(buf, size, "pty, peer side %s%s%s", t->name,
+                         t->link[0] ? " via " : "", t->link);
+            break;
+        case TRANSPORT_TCP:
+            n = snprintf(buf, size, "tcp %s", t->name);
+            break;
+        case TRANSPORT_REPLAY:
+            if (t->is_capture && t->baud > 0) n = snprintf(buf, size, "replay of capture %s at recorded speed", t->name);
+            else if (t->is_capture) n = snprintf(buf, size, "replay of capture %s, unpaced", t->name);
+            else if (t->baud > 0) n = snprintf(buf, size, "replay of %s at %d baud", t->name, t->baud);
+            else n = snprintf(buf, size, "replay of %s, unpaced", t->name);
+            break;
+        default:
+            n = snprintf(buf, size, "?");
+            break;
+    }
+    return n < 0 ? -1 : 0;
+}
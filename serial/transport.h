@@ -0,0 +1,47 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "serial_port.h"
+#include "../radios/cat_capture.h"
+
+#define TRANSPORT_NAME_LEN 128
+
+typedef enum {
+    TRANSPORT_TTY,          /* Real serial port: "/dev/ttyUSB0" or "tty:/dev/ttyUSB0" */
+    TRANSPORT_PTY,          /* Pseudo-terminal pair: "pty:" or "pty:/path/to/link" */
+    TRANSPORT_TCP,          /* Stream socket: "tcp:port" or "tcp:host:port" */
+    TRANSPORT_REPLAY        /* Recorded radio output: "replay:/path/to/file", raw bytes or a capture */
+} transport_kind_t;
+
+/* Byte stream to a radio or something pretending to be one. Every backend hands out
+ * one non-blocking fd that reads, writes and polls like a serial port, so the
+ * framer, serial_io and port_engine work unchanged on top of it. */
+typedef struct {
+    transport_kind_t kind;
+    int fd;                         /* The program's side, -1 once closed or released */
+    int peer_fd;                    /* PTY slave kept open / replay socket end, -1 otherwise */
+    char name[TRANSPORT_NAME_LEN];  /* Device, peer path, address or file, for logs */
+    char link[TRANSPORT_NAME_LEN];  /* Symlink created for a PTY peer, empty if none */
+    int baud;                       /* Line rate: applied (tty) or simulated (replay) */
+    serial_port_info_t port;        /* TTY only: what the kernel applied */
+    /* Replay feeder */
+    int replay_fd;
+    int stop_fd;
+    bool is_capture;                /* Timestamped capture rather than raw bytes */
+    cat_capture_reader_t capture;
+    pthread_t thread;
+    bool running;
+} transport_t;
+
+/* Function Prototypes */
+int transport_open(transport_t *t, const char *spec, int baud);
+int transport_release_fd(transport_t *t);
+void transport_close(transport_t *t);
+int transport_describe(const transport_t *t, char *buf, size_t size);
+const char *transport_kind_name(transport_kind_t kind);
+
+#endif /* TRANSPORT_H */
@@ -0,0 +1,94 @@
+#include "tx_queue.h"
+#include "../radios/cat_framer.h"
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define QUEUE_MASK (TX_QUEUE_SIZE - 1)
+
+void tx_queue_reset(tx_queue_t *q) {
+    if (!q) return;
+
+    q->head = 0;
+    q->tail = 0;
+    q->bytes_sent = 0;
+    q->syscalls = 0;
+    q->last_write_ns = 0;
+}
+
+size_t tx_queue_pending(const tx_queue_t *q) {
+    return q ? q->head - q->tail : 0;
+}
+
+bool tx_queue_empty(const tx_queue_t *q) {
+    return tx_queue_pending(q) == 0;
+}
+
+static void append(tx_queue_t *q, const char *data, size_t len) {
+    size_t offset = q->head & QUEUE_MASK;
+    size_t first = TX_QUEUE_SIZE - offset;
+
+    if (first > len) first = len;
+    memcpy(q->buf + offset, data, first);
+    memcpy(q->buf, data + first, len - first);
+    q->head += len;
+}
+
+/* Append one frame assembled from several pieces. All or nothing: -1 if it does not fit. */
+int tx_queue_pushv(tx_queue_t *q, const struct iovec *iov, int iovcnt) {
+    if (!q || (!iov && iovcnt > 0)) return -1;
+
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        total += iov[i].iov_len;
+    }
+    if (total > TX_QUEUE_SIZE - tx_queue_pending(q)) return -1;
+
+    for (int i = 0; i < iovcnt; ++i) {
+        append(q, iov[i].iov_base, iov[i].iov_len);
+    }
+    return 0;
+}
+
+int tx_queue_push(tx_queue_t *q, const char *data, size_t len) {
+    struct iovec iov = { .iov_base = (void *)data, .iov_len = len };
+    return tx_queue_pushv(q, &iov, 1);
+}
+
+/* Send as much as the kernel takes in one writev(). Returns bytes written,
+ * 0 if the port is full (retry on POLLOUT), -1 on error with errno set. */
+ssize_t tx_queue_flush(tx_queue_t *q, int fd) {
+    if (!q) return -1;
+
+    size_t pending = tx_queue_pending(q);
+    if (pending == 0) return 0;
+
+    size_t offset = q->tail & QUEUE_MASK;
+    size_t first = TX_QUEUE_SIZE - offset;
+    struct iovec iov[2];
+    int iovcnt = 1;
+
+    iov[0].iov_base = q->buf + offset;
+    iov[0].iov_len = pending < first ? pending : first;
+    if (pending > first) {
+        iov[1].iov_base = q->buf;
+        iov[1].iov_len = pending - first;
+        iovcnt = 2;
+    }
+
+    ssize_t n;
+    do {
+        n = writev(fd, iov, iovcnt);
+    } while (n < 0 && errno == EINTR);
+    q->syscalls++;
+
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+
+    q->last_write_ns = cat_monotonic_ns();   /* same clock as the framer's RX stamps */
+
+    q->tail += (size_t)n;
+    q->bytes_sent += (uint64_t)n;
+    return n;
+}
@@ -0,0 +1,32 @@
+#ifndef TX_QUEUE_H
+#define TX_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/* Queue size must be a power of two */
+#define TX_QUEUE_SIZE 8192
+
+/* Outgoing byte ring for one non-blocking port. Frames are appended whole
+ * and flushed with a single writev() per call, partial writes stay queued. */
+typedef struct {
+    char buf[TX_QUEUE_SIZE];
+    size_t head;            /* Next byte to append (monotonic) */
+    size_t tail;            /* Next byte to send (monotonic) */
+    uint64_t bytes_sent;
+    uint64_t syscalls;
+    uint64_t last_write_ns; /* CLOCK_MONOTONIC time the last writev() returned */
+} tx_queue_t;
+
+/* Function Prototypes */
+void tx_queue_reset(tx_queue_t *q);
+int tx_queue_pushv(tx_queue_t *q, const struct iovec *iov, int iovcnt);
+int tx_queue_push(tx_queue_t *q, const char *data, size_t len);
+ssize_t tx_queue_flush(tx_queue_t *q, int fd);
+size_t tx_queue_pending(const tx_queue_t *q);
+bool tx_queue_empty(const tx_queue_t *q);
+
+#endif /* TX_QUEUE_H */
@@ -2,162 +2,1057 @@
  * serial_send.c  – version 1.0
  *
  * Fonctionnalités :
- *   • options -d <device>, -b <baud>, -l (liste des bauds), -h (aide)
- *   • vérification du baud après configuration
- *   • boucle full‑duplex (select() sur stdin + le port série)
+ *   • options -d <device> (répétable), -b <baud>, -w <capture>, -l (liste
+ *     des bauds), -h (aide)
+ *   • débit quelconque (termios2/BOTHER), basse latence du pilote, et
+ *     rapport de ce que le noyau a réellement appliqué
+ *   • ports simulés (pty:, tcp:, replay:) pour tester sans radio
+ *   • boucle full‑duplex epoll (stdin + N ports série, chacun avec son
+ *     tampon de lecture et sa file d’écriture)
+ *   • échéance par lecture CAT (timerfd unique) : renvoi avec attente
+ *     croissante plafonnée, puis échec signalé
+ *   • enregistrement horodaté de tout le trafic (radios/cat_capture.h),
+ *     rejouable avec -d replay:fichier ou bench/capture_replay
+ *   • cache des lectures récentes (par opcode + VFO, durée de validité
+ *     propre à chaque paramètre) : pas de trafic série pour une valeur
+ *     lue ou poussée par AI1 il y a quelques millisecondes
+ *   • état de la radio publié en mémoire partagée (-m, radios/radio_shm.h)
+ *     pour les autres processus locaux : lecture sans verrou ni trafic
+ *   • mode serveur sans terminal (-s) : plusieurs logiciels partagent la
+ *     radio via une socket Unix ou TCP ; les lectures identiques en vol ne
+ *     coûtent qu’une transaction série, les trames AI sont diffusées
+ *   • mode lot pour les scripts (-f fichier, ou - pour stdin) : les lectures
+ *     partent par la fenêtre du port sans attendre chaque réponse ; une
+ *     ligne par commande sur stdout (commande, réponse, latence en ms)
  *
  * Compilation :
- *     gcc -Wall -O2 -o serial_chat_full serial_chat_full.c
+ *     make serial-send
  */
 
+#define _GNU_SOURCE     /* accept4 */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
-#include <termios.h>
 #include <errno.h>
-#include <sys/select.h>
+#include <stdbool.h>
 #include <getopt.h>
+#include <signal.h>
+#include <netdb.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "serial/port_engine.h"
+#include "serial/transport.h"
+#include "radios/cat_pipeline.h"
+#include "radios/radio_state.h"
+#include "radios/radio_shm.h"
 
 #define DEFAULT_DEVICE   "/dev/ttyUSB0"
 #define DEFAULT_BAUD     38400          /* valeur numérique */
 #define MAX_LINE         1024
+#define MAX_PORTS        16             /* nombre de -d acceptés */
+#define MAX_CLIENTS      32             /* clients simultanés en mode serveur */
+#define SHARED_READS     (CAT_PIPELINE_MAX_DEPTH + CAT_PIPELINE_BACKLOG)
+#define CLIENT_SETS      (CAT_PIPELINE_BACKLOG + CAT_PIPELINE_SETS)    /* en file, puis notés */
+
+static FILE *info;   /* messages d’état : stderr en mode lot, stdout réservé aux résultats */
 
 /* -------------------------------------------------------------------------- */
-/* Table des bauds supportés – utilisée par -l et par la conversion */
-static const struct {
-    int      baud;
-    speed_t  constant;
-} baud_table[] = {
-    { 1200,   B1200   },
-    { 2400,   B2400   },
-    { 4800,   B4800   },
-    { 9600,   B9600   },
-    { 19200,  B19200  },
-    { 38400,  B38400  },
-    { 57600,  B57600  },
-    { 115200, B115200 },
-    { 230400, B230400 },
-    { 460800, B460800 },
-    { 921600, B921600 }
-};
-#define BAUD_TABLE_SIZE (sizeof(baud_table)/sizeof(baud_table[0]))
+static void print_supported_bauds(void)
+{
+    puts("Bauds standards (constante termios) :");
+    for (size_t i = 0; serial_port_standard_rate(i); ++i)
+        printf("  %6d\n", serial_port_standard_rate(i));
+    puts("Tout autre débit est demandé tel quel (termios2 / BOTHER) ;\n"
+         "le débit réellement appliqué est affiché à l’ouverture.");
+}
 
 /* -------------------------------------------------------------------------- */
-static speed_t baud_to_constant(int baud)
+/* Ouvre un port réel ou simulé et affiche ce qui a été réellement appliqué */
+static int open_transport(transport_t *t, const char *spec, int baudrate)
 {
-    for (size_t i = 0; i < BAUD_TABLE_SIZE; ++i)
-        if (baud_table[i].baud == baud)
-            return baud_table[i].constant;
+    char report[256];
 
-    fprintf(stderr,
-            "⚠️  Baud %d non supporté – utilisation du défaut %d.\n",
-            baud, DEFAULT_BAUD);
-    return B38400;   /* fallback */
+    if (transport_open(t, spec, baudrate) < 0) {
+        perror(spec);
+        return -1;
+    }
+
+    transport_describe(t, report, sizeof(report));
+    fprintf(info, "    %s\n", report);
+    if (t->kind == TRANSPORT_TTY && !serial_port_rate_exact(&t->port)) {
+        fprintf(stderr,
+                "⚠️  Le baud demandé (%d) n’a pas pu être appliqué exactement.\n",
+                baudrate);
+    }
+    return 0;
 }
 
 /* -------------------------------------------------------------------------- */
-static void print_supported_bauds(void)
+static void print_usage(const char *progname)
 {
-    puts("Bauds supportés (valeur décimale → constante termios) :");
-    for (size_t i = 0; i < BAUD_TABLE_SIZE; ++i)
-        printf("  %6d → %s\n", baud_table[i].baud,
-               (baud_table[i].constant == B38400)   ? "B38400"   :
-               (baud_table[i].constant == B115200) ? "B115200"  :
-               (baud_table[i].constant == B230400) ? "B230400"  :
-               (baud_table[i].constant == B460800) ? "B460800"  :
-               (baud_table[i].constant == B921600) ? "B921600"  :
-               "autre");
+    printf(
+        "Usage: %s [options]\n"
+        "\nOptions :\n"
+        "  -d <device>   Chemin du périphérique série (défaut : %s).\n"
+        "                Répétable : un seul processus pilote tous les ports.\n"
+        "                Sans radio : pty:[lien], tcp:[hôte:]port, replay:fichier.\n"
+        "  -b <baud>     Baudrate (défaut : %d), standard ou non. Voir -l.\n"
+        "  -w <fichier>  Enregistrer le trafic brut horodaté (ajout si le fichier existe).\n"
+        "  -C            Sans cache : toute lecture part vers la radio.\n"
+        "  -m <nom>      Publier l’état du port 0 en mémoire partagée (ex. %s).\n"
+        "  -s <adresse>  Mode serveur, sans lecture de stdin : unix:/chemin ou\n"
+        "                tcp:[hôte:]port (127.0.0.1 par défaut). SIGINT/SIGTERM pour quitter.\n"
+        "  -f <fichier>  Mode lot : envoyer les commandes du fichier (- : stdin) et\n"
+        "                écrire « commande<TAB>réponse<TAB>latence ms » par ligne.\n"
+        "  -l            Lister les baudrates supportés et quitter.\n"
+        "  -h            Afficher cette aide.\n"
+        "\nExemples :\n"
+        "  %s                     # /dev/ttyUSB0 @ 38400\n"
+        "  %s -d /dev/ttyUSB1    # même baud, autre device\n"
+        "  %s -b 115200          # 115200 baud\n"
+        "  %s -l                 # afficher les bauds supportés\n"
+        "  %s -d /dev/ttyUSB0 -d /dev/ttyUSB1   # CAT-1 et CAT-2 du FTX-1\n"
+        "  %s -d pty:/tmp/ftx1   # pty, l’autre côté via le lien /tmp/ftx1\n"
+        "  %s -w session.cap     # enregistrer, puis rejouer : -d replay:session.cap\n"
+        "  %s -s unix:/run/ftx1.sock   # partager la radio entre plusieurs logiciels\n"
+        "  %s -m %s   # lire ensuite : bench/shm_bench -p %s\n"
+        "  %s -f commandes.txt > resultats.tsv   # code de sortie ≠ 0 si une commande échoue\n"
+        "\nAvec plusieurs ports, « @N texte » envoie au port N et « @N » seul\n"
+        "le choisit pour les lignes suivantes (port 0 par défaut).\n"
+        "En mode serveur, les clients parlent CAT directement ; avec deux ports,\n"
+        "PTT et manipulation CW passent par le second (CAT-2), le reste par le premier.\n",
+        progname, DEFAULT_DEVICE, DEFAULT_BAUD, RADIO_SHM_DEFAULT_NAME,
+        progname, progname, progname, progname, progname, progname, progname, progname,
+        progname, RADIO_SHM_DEFAULT_NAME, RADIO_SHM_DEFAULT_NAME, progname);
 }
 
 /* -------------------------------------------------------------------------- */
-static int init_serial(const char *device, int baudrate)
+struct session;
+
+/* Mode serveur : une lecture demandée par un ou plusieurs clients pendant
+ * qu’elle était en vol ; la réponse unique leur est renvoyée à tous */
+typedef struct {
+    bool            used;
+    bool            sealed;                 /* un réglage est passé après : plus de nouveaux clients */
+    uint32_t        key;                    /* cat_request_key() : opcode + VFO */
+    engine_port_t  *waiters[MAX_CLIENTS];   /* NULL : client parti entre‑temps */
+    size_t          count;
+    struct session *session;
+} shared_read_t;
+
+/* Mode serveur : réglage d’un client, qui seul doit recevoir le « ?; » d’un refus */
+typedef struct {
+    bool            used;
+    engine_port_t  *client;                 /* NULL : client parti entre‑temps */
+    struct session *session;
+} client_set_t;
+
+/* Lectures CAT en vol d’un port : chacune a son échéance */
+typedef struct {
+    engine_port_t  *port;              /* NULL une fois le port fermé */
+    port_engine_t  *engine;
+    cat_pipeline_t  pipe;
+    cat_cache_t     cache;             /* réponses récentes et trames AI */
+    shared_read_t   shared[SHARED_READS];
+    client_set_t    sets[CLIENT_SETS];
+} port_ctx_t;
+
+/* Mode lot (-f) : une trame du fichier, puis sa réponse une fois arrivée */
+typedef struct {
+    size_t               text;         /* position dans batch_t.text */
+    size_t               len;
+    int                  port;
+    bool                 read;         /* passe par la fenêtre du port */
+    bool                 done;
+    cat_request_status_t status;
+    char                 answer[CAT_FRAMER_MAX_FRAME];
+    size_t               answer_len;
+    uint64_t             rtt_ns;
+} batch_cmd_t;
+
+/* Les commandes partent dans l’ordre du fichier tant que la fenêtre et la
+ * file d’attente du port ont de la place ; les résultats sortent dans le
+ * même ordre, quel que soit l’ordre des réponses */
+typedef struct {
+    char        *text;                 /* trames normalisées, « ; » final compris */
+    batch_cmd_t *cmds;
+    size_t       count;
+    size_t       next;                 /* première commande pas encore envoyée */
+    size_t       printed;              /* premières commandes déjà écrites */
+    size_t       failed;               /* refusées, sans réponse ou annulées */
+    size_t       text_len, text_cap, cap;
+    uint64_t     start_ns;
+} batch_t;
+
+/* État de la boucle : moteur epoll, port par défaut et ligne stdin en cours */
+typedef struct session {
+    port_engine_t engine;
+    transport_t   transports[MAX_PORTS];
+    port_ctx_t    ports[MAX_PORTS];   /* indexé par l’id du port */
+    size_t        radio_count;        /* ports radio encore ouverts */
+    cat_capture_t capture;            /* -w ; fd à -1 sans enregistrement */
+    radio_shm_t   shm;                /* -m ; seg à NULL sans publication */
+    radio_state_t state;              /* état décodé du port 0, publié par -m */
+    int           timer_fd;           /* une seule minuterie : la plus proche échéance */
+    uint64_t      timer_at;
+    int           target;             /* port des lignes sans préfixe @N */
+    char          line[MAX_LINE];
+    size_t        line_len;
+    bool          quit;
+    /* Mode serveur (-s) */
+    int            listen_fd;         /* -1 hors mode serveur */
+    char           unix_path[sizeof(((struct sockaddr_un *)0)->sun_path)];   /* supprimée en sortie */
+    engine_port_t *clients[MAX_CLIENTS];
+    size_t         client_count;
+    unsigned       client_serial;     /* pour nommer les clients */
+    uint64_t       client_reads;
+    uint64_t       merged_reads;      /* servies par une lecture déjà en vol */
+    /* Mode lot (-f) */
+    batch_t       *batch;             /* NULL en mode interactif ou serveur */
+} session_t;
+
+static volatile sig_atomic_t stop_requested;
+
+/* -------------------------------------------------------------------------- */
+static int pipe_write(const char *frame, size_t len, void *io_data)
 {
-    int fd = open(device, O_RDWR | O_NOCTTY | O_SYNC);
-    if (fd < 0) {
-        perror("open");
+    port_ctx_t *ctx = io_data;
+    if (!ctx->port)
         return -1;
+    return port_engine_send(ctx->engine, ctx->port, frame, len);
+}
+
+static void on_answer(cat_request_status_t status, const cat_response_t *resp,
+                      const char *frame, size_t len, uint64_t rtt_ns, void *user_data)
+{
+    (void)resp;
+    port_ctx_t *ctx = user_data;
+    const char *name = ctx->port ? ctx->port->name : "?";
+
+    switch (status) {
+        case CAT_REQUEST_OK:
+        case CAT_REQUEST_REJECTED:
+            if (rtt_ns == 0)
+                printf("[←] %s : %.*s  (cache)\n", name, (int)len, frame);
+            else
+                printf("[←] %s : %.*s  (%.3f ms)\n", name, (int)len, frame, rtt_ns / 1e6);
+            break;
+        case CAT_REQUEST_TIMEOUT:
+            printf("[!] %s : pas de réponse après %u essai(s), %.0f ms.\n",
+                   name, ctx->pipe.max_retries + 1, rtt_ns / 1e6);
+            break;
+        case CAT_REQUEST_CANCELLED:
+            break;
     }
+}
 
-    struct termios tty;
-    if (tcgetattr(fd, &tty) != 0) {
-        perror("tcgetattr");
-        close(fd);
-        return -1;
+/* Un réglage ne reçoit une réponse que s’il est refusé */
+static void on_set_answer(cat_request_status_t status, const cat_response_t *resp,
+                          const char *frame, size_t len, uint64_t rtt_ns, void *user_data)
+{
+    (void)resp;
+    port_ctx_t *ctx = user_data;
+
+    if (status == CAT_REQUEST_REJECTED)
+        printf("[←] %s : %.*s  (réglage refusé, %.3f ms)\n", ctx->port ? ctx->port->name : "?",
+               (int)len, frame, rtt_ns / 1e6);
+}
+
+/* Arme le timerfd sur la plus proche échéance de tous les ports (0 = désarmé) */
+static void arm_timer(session_t *s)
+{
+    uint64_t next = 0;
+    for (size_t i = 0; i < MAX_PORTS; ++i) {
+        uint64_t d = cat_pipeline_next_deadline(&s->ports[i].pipe);
+        if (d && (next == 0 || d < next))
+            next = d;
     }
+    if (next == s->timer_at)
+        return;
 
-    /* --- Vitesse -------------------------------------------------------- */
-    speed_t speed = baud_to_constant(baudrate);
-    cfsetospeed(&tty, speed);
-    cfsetispeed(&tty, speed);
+    struct itimerspec its = {
+        .it_value = { .tv_sec = (time_t)(next / 1000000000ull), .tv_nsec = (long)(next % 1000000000ull) },
+    };
+    if (timerfd_settime(s->timer_fd, TFD_TIMER_ABSTIME, &its, NULL) == 0)
+        s->timer_at = next;
+}
 
-    /* --- Format 8N1, pas de contrôle de flux --------------------------- */
-    tty.c_cflag = (tty.c_cflag & ~CSIZE) | CS8;   /* 8 bits de données */
-    tty.c_cflag &= ~PARENB;                       /* pas de parité */
-    tty.c_cflag &= ~CSTOPB;                       /* 1 bit de stop */
-    tty.c_cflag &= ~CRTSCTS;                      /* pas de RTS/CTS */
-    tty.c_cflag |= CREAD | CLOCAL;                /* activer la lecture, ignorer le contrôle de ligne */
+static void on_timer(int fd, uint32_t events, void *user_data)
+{
+    (void)events;
+    session_t *s = user_data;
+    uint64_t expirations;
 
-    /* --- Mode RAW (pas de transformation) ----------------------------- */
-    tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
-    tty.c_iflag &= ~(IXON | IXOFF | IXANY | ICRNL | INLCR | IGNCR);
-    tty.c_oflag &= ~OPOST;
+    if (read(fd, &expirations, sizeof(expirations)) < 0)
+        return;
+    s->timer_at = 0;
 
-    /* --- Timeout de lecture (0,5 s) ------------------------------------ */
-    tty.c_cc[VMIN]  = 0;   /* aucun octet minimum requis */
-    tty.c_cc[VTIME] = 5;   /* décisecondes → 0,5 s */
+    uint64_t now = cat_monotonic_ns();
+    for (size_t i = 0; i < MAX_PORTS; ++i) {
+        port_ctx_t *ctx = &s->ports[i];
+        uint64_t retries = ctx->pipe.retries;
 
-    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
-        perror("tcsetattr");
-        close(fd);
+        if (!cat_pipeline_expire(&ctx->pipe, now))
+            continue;
+        if (ctx->pipe.retries > retries)
+            fprintf(info, "[↻] %s : %llu lecture(s) renvoyée(s).\n", ctx->port ? ctx->port->name : "?",
+                    (unsigned long long)(ctx->pipe.retries - retries));
+        cat_pipeline_pump(&ctx->pipe);
+    }
+    fflush(stdout);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Mode serveur. Les clients sont des pairs du moteur (tampon de lecture et
+ * file d’écriture propres) dont user_data reste NULL ; celui des ports radio
+ * pointe sur leur port_ctx_t. Tout passe par la file du port, dans l’ordre :
+ * les lectures par sa fenêtre, fusionnées par clé, les réglages derrière elles. */
+
+/* Retire un client de la liste et de toutes les lectures qu’il attend */
+static void forget_client(session_t *s, engine_port_t *client)
+{
+    for (size_t i = 0; i < s->client_count; ++i) {
+        if (s->clients[i] == client) {
+            s->clients[i] = s->clients[--s->client_count];
+            break;
+        }
+    }
+    for (size_t p = 0; p < MAX_PORTS; ++p) {
+        for (size_t r = 0; r < SHARED_READS; ++r) {
+            shared_read_t *sr = &s->ports[p].shared[r];
+            for (size_t w = 0; sr->used && w < sr->count; ++w) {
+                if (sr->waiters[w] == client)
+                    sr->waiters[w] = NULL;
+            }
+        }
+        for (size_t r = 0; r < CLIENT_SETS; ++r) {
+            if (s->ports[p].sets[r].client == client)
+                s->ports[p].sets[r].client = NULL;
+        }
+    }
+}
+
+/* Un client qui ne lit plus ses réponses ne doit pas bloquer les autres */
+static void send_to_client(session_t *s, engine_port_t *client, const char *frame, size_t len)
+{
+    if (port_engine_send(&s->engine, client, frame, len) == 0)
+        return;
+    printf("[-] %s : file d’écriture pleine ou client parti, déconnecté.\n", client->name);
+    forget_client(s, client);
+    port_engine_remove_port(&s->engine, client);
+}
+
+/* Trames spontanées de la radio (AI, « ?; » orphelins) : à tous les clients */
+static void broadcast(session_t *s, const char *frame, size_t len)
+{
+    for (size_t i = s->client_count; i-- > 0; )
+        send_to_client(s, s->clients[i], frame, len);
+}
+
+static void on_shared_answer(cat_request_status_t status, const cat_response_t *resp,
+                             const char *frame, size_t len, uint64_t rtt_ns, void *user_data)
+{
+    (void)resp;
+    (void)rtt_ns;
+    shared_read_t *sr = user_data;
+
+    /* Sans réponse : rien, comme la radio elle‑même ; chaque client a sa propre échéance */
+    if (status == CAT_REQUEST_OK || status == CAT_REQUEST_REJECTED) {
+        for (size_t w = 0; w < sr->count; ++w) {
+            if (sr->waiters[w])
+                send_to_client(sr->session, sr->waiters[w], frame, len);
+        }
+    }
+    sr->used = false;
+}
+
+static void on_client_set(cat_request_status_t status, const cat_response_t *resp,
+                          const char *frame, size_t len, uint64_t rtt_ns, void *user_data)
+{
+    (void)resp;
+    (void)rtt_ns;
+    client_set_t *cs = user_data;
+
+    if (status == CAT_REQUEST_REJECTED && cs->client)
+        send_to_client(cs->session, cs->client, frame, len);
+    cs->used = false;
+    cs->client = NULL;
+}
+
+/* Une lecture en vol avant ce réglage donnera l’ancienne valeur : les lectures
+ * qui le suivent ne s’y joignent plus. Un réglage inconnu (bande, A=B…) peut
+ * toucher plusieurs valeurs et ferme toutes les lectures en vol. */
+static void seal_shared_reads(port_ctx_t *ctx, const char *frame, size_t len)
+{
+    cat_response_t resp;
+    uint32_t key = cat_request_key(frame, len);
+    bool one = key && cat_dispatch_response(frame, len, &resp) == 0;
+
+    for (size_t r = 0; r < SHARED_READS; ++r) {
+        shared_read_t *sr = &ctx->shared[r];
+        if (sr->used && (!one || sr->key == key))
+            sr->sealed = true;
+    }
+}
+
+/* Le réglage attend derrière les lectures déjà en file, les siennes comprises ;
+ * son refus éventuel revient à son auteur, pas au client de la plus ancienne lecture */
+static void client_set(session_t *s, port_ctx_t *ctx, engine_port_t *client,
+                       const char *frame, size_t len)
+{
+    client_set_t *cs = NULL;
+    for (size_t r = 0; r < CLIENT_SETS && !cs; ++r) {
+        if (!ctx->sets[r].used)
+            cs = &ctx->sets[r];
+    }
+
+    if (cs) {
+        *cs = (client_set_t){ .used = true, .client = client, .session = s };
+        if (cat_pipeline_submit_set(&ctx->pipe, frame, len, on_client_set, cs) == 0) {
+            seal_shared_reads(ctx, frame, len);
+            cat_pipeline_pump(&ctx->pipe);
+            return;
+        }
+        cs->used = false;
+        cs->client = NULL;
+    }
+    send_to_client(s, client, "?;", 2);   /* file pleine ou trame trop longue pour le CAT */
+}
+
+/* Une lecture identique déjà en vol (ou en attente de fenêtre) sert aussi ce client */
+static void client_read(session_t *s, port_ctx_t *ctx, engine_port_t *client,
+                        const char *frame, size_t len)
+{
+    uint32_t key = cat_request_key(frame, len);
+    shared_read_t *slot = NULL;
+
+    s->client_reads++;
+    for (size_t r = 0; r < SHARED_READS; ++r) {
+        shared_read_t *sr = &ctx->shared[r];
+        if (!sr->used) {
+            if (!slot)
+                slot = sr;
+        } else if (!sr->sealed && sr->key == key && sr->count < MAX_CLIENTS) {
+            sr->waiters[sr->count++] = client;
+            s->merged_reads++;
+            return;
+        }
+    }
+
+    if (slot) {
+        slot->used = true;
+        slot->sealed = false;
+        slot->key = key;
+        slot->waiters[0] = client;
+        slot->count = 1;
+        slot->session = s;
+        if (cat_pipeline_submit_frame(&ctx->pipe, frame, len, on_shared_answer, slot) == 0) {
+            cat_pipeline_pump(&ctx->pipe);   /* dans l’ordre des réglages qui suivent */
+            return;
+        }
+        slot->used = false;
+    }
+    send_to_client(s, client, "?;", 2);   /* fenêtre et file pleines : la radio est saturée */
+}
+
+/* CAT-2, s’il existe, porte PTT et manipulation CW comme dans l’interface graphique */
+static port_ctx_t *client_route(session_t *s, const char *frame, size_t len)
+{
+    if (cat_command_class(frame, len) == CAT_CLASS_TX && s->ports[1].port)
+        return &s->ports[1];
+    return s->ports[0].port ? &s->ports[0] : NULL;
+}
+
+static void on_client_frames(session_t *s, engine_port_t *client,
+                             const cat_frame_t *frames, size_t count)
+{
+    for (size_t i = 0; i < count && !client->handle.closed; ++i) {
+        const char *frame = frames[i].data;
+        size_t len = frames[i].len;
+        port_ctx_t *ctx = client_route(s, frame, len);
+
+        if (!ctx) {
+            send_to_client(s, client, "?;", 2);
+        } else if (cat_is_read_request(frame, len)) {
+            client_read(s, ctx, client, frame, len);
+        } else {
+            client_set(s, ctx, client, frame, len);
+        }
+    }
+}
+
+static void on_accept(int fd, uint32_t events, void *user_data)
+{
+    (void)events;
+    session_t *s = user_data;
+
+    for (;;) {
+        int c = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (c < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                perror("accept");
+            return;
+        }
+        if (s->client_count == MAX_CLIENTS) {
+            fprintf(stderr, "⚠️  Trop de clients (max %d), connexion refusée.\n", MAX_CLIENTS);
+            close(c);
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(c, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));   /* échoue sans dommage en Unix */
+
+        char name[32];
+        snprintf(name, sizeof(name), "client %u", ++s->client_serial);
+        engine_port_t *client = port_engine_add_peer(&s->engine, c, name);
+        if (!client) {
+            perror("epoll_ctl(client)");
+            close(c);
+            continue;
+        }
+        s->clients[s->client_count++] = client;
+        printf("[+] %s connecté (%zu client(s)).\n", name, s->client_count);
+    }
+}
+
+/* « unix:/chemin » ou « tcp:[hôte:]port » ; en TCP, 127.0.0.1 si l’hôte est omis
+ * pour ne pas exposer la radio au réseau sans le demander */
+static int open_listener(session_t *s, const char *spec)
+{
+    int fd = -1;
+
+    if (strncmp(spec, "unix:", 5) == 0) {
+        struct sockaddr_un sun = { .sun_family = AF_UNIX };
+        const char *path = spec + 5;
+        struct stat st;
+
+        if (*path == '\0' || strlen(path) >= sizeof(sun.sun_path)) {
+            errno = EINVAL;
+            return -1;
+        }
+        strcpy(sun.sun_path, path);
+        if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+            unlink(path);   /* socket laissée par une instance précédente */
+
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0 || bind(fd, (struct sockaddr *)&sun, sizeof(sun)) < 0)
+            goto fail;
+        strcpy(s->unix_path, path);
+    } else if (strncmp(spec, "tcp:", 4) == 0) {
+        char host[256] = "127.0.0.1";
+        const char *port = spec + 4;
+        const char *colon = strrchr(port, ':');
+        if (colon) {
+            size_t n = (size_t)(colon - port);
+            if (n >= sizeof(host)) {
+                errno = EINVAL;
+                return -1;
+            }
+            memcpy(host, port, n);
+            host[n] = '\0';
+            port = colon + 1;
+        }
+
+        struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM, .ai_flags = AI_PASSIVE };
+        struct addrinfo *res = NULL;
+        int rc = getaddrinfo(host[0] ? host : NULL, port, &hints, &res);
+        if (rc != 0) {
+            fprintf(stderr, "%s : %s\n", spec, gai_strerror(rc));
+            errno = EINVAL;
+            return -1;
+        }
+        for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+            int one = 1;
+            fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+            if (fd < 0)
+                continue;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+                break;
+            close(fd);
+            fd = -1;
+        }
+        freeaddrinfo(res);
+        if (fd < 0)
+            return -1;
+    } else {
+        errno = EINVAL;
         return -1;
     }
 
-    /* Vérification post‑configuration (facultative mais utile) */
-    speed_t cur_in  = cfgetispeed(&tty);
-    speed_t cur_out = cfgetospeed(&tty);
-    if (cur_in != speed || cur_out != speed) {
-        fprintf(stderr,
-                "⚠️  Le baud demandé (%d) n’a pas pu être appliqué exactement.\n",
-                baudrate);
+    if (listen(fd, 16) < 0)
+        goto fail;
+    s->listen_fd = fd;
+    return 0;
+
+fail:
+    if (fd >= 0)
+        close(fd);
+    if (s->unix_path[0]) {
+        unlink(s->unix_path);
+        s->unix_path[0] = '\0';
     }
+    return -1;
+}
 
-    tcflush(fd, TCIOFLUSH);   /* vider les tampons */
-    return fd;
+static void on_stop_signal(int sig)
+{
+    (void)sig;
+    stop_requested = 1;
 }
 
 /* -------------------------------------------------------------------------- */
-static void print_usage(const char *progname)
+static void on_port_frames(engine_port_t *port, const cat_frame_t *frames,
+                           size_t count, void *user_data)
 {
-    printf(
-        "Usage: %s [options]\n"
-        "\nOptions :\n"
-        "  -d <device>   Chemin du périphérique série (défaut : %s)\n"
-        "  -b <baud>     Baudrate (défaut : %d). Voir -l pour la liste.\n"
-        "  -l            Lister les baudrates supportés et quitter.\n"
-        "  -h            Afficher cette aide.\n"
-        "\nExemples :\n"
-        "  %s                     # /dev/ttyUSB0 @ 38400\n"
-        "  %s -d /dev/ttyUSB1    # même baud, autre device\n"
-        "  %s -b 115200          # 115200 baud\n"
-        "  %s -l                 # afficher les bauds supportés\n",
-        progname, DEFAULT_DEVICE, DEFAULT_BAUD,
-        progname, progname, progname, progname);
+    session_t *s = user_data;
+    port_ctx_t *ctx = port->user_data;
+
+    if (!ctx) {
+        on_client_frames(s, port, frames, count);
+        fflush(stdout);
+        return;
+    }
+
+    /* Réponses et trames AI : l’état publié suit tout ce que dit la radio */
+    if (s->shm.seg && ctx == &s->ports[0]) {
+        uint32_t changed = 0;
+        for (size_t i = 0; i < count; ++i)
+            changed |= radio_state_feed(&s->state, frames[i].data, frames[i].len);
+        if (changed)
+            radio_shm_publish(&s->shm, &s->state);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (cat_pipeline_on_frame(&ctx->pipe, frames[i].data, frames[i].len, frames[i].rx_ns))
+            continue;
+        if (s->listen_fd >= 0)
+            broadcast(s, frames[i].data, frames[i].len);
+        else
+            fprintf(info, "[←] %s : %.*s\n", port->name, (int)frames[i].len, frames[i].data);
+    }
+    cat_pipeline_pump(&ctx->pipe);
+    fflush(stdout);
+}
+
+static void on_port_closed(engine_port_t *port, void *user_data)
+{
+    session_t *s = user_data;
+    port_ctx_t *ctx = port->user_data;
+
+    if (!ctx) {
+        forget_client(s, port);
+        printf("[-] %s déconnecté (%zu client(s)).\n", port->name, s->client_count);
+        fflush(stdout);
+        return;
+    }
+
+    fprintf(info, "[←] %s : périphérique fermé.\n", port->name);
+    ctx->port = NULL;
+    cat_pipeline_cancel(&ctx->pipe);
+    if (--s->radio_count == 0)   /* c’était le dernier */
+        s->quit = true;
+}
+
+/* Les trames CAT passent par la file du port dans l’ordre de la ligne : les
+ * lectures par sa fenêtre (échéance, renvoi), les réglages derrière les
+ * lectures qui les précèdent. Le texte sans « ; » part tel quel. */
+static int send_segments(session_t *s, engine_port_t *port, const char *line, size_t len,
+                         size_t *sent, size_t *waiting)
+{
+    port_ctx_t *ctx = &s->ports[port->id];
+    size_t start = 0;
+
+    while (start < len) {
+        const char *semi = memchr(line + start, ';', len - start);
+        size_t end = semi ? (size_t)(semi - line) + 1 : len;
+        size_t skip = start;
+        while (skip < end && (line[skip] == ' ' || line[skip] == '\r' || line[skip] == '\n'))
+            skip++;
+
+        const char *frame = line + skip;
+        size_t frame_len = end - skip;
+
+        if (skip > start && port_engine_send(&s->engine, port, line + start, skip - start) < 0)
+            return -1;
+        if (frame_len == 0) {   /* le seul '\n' de fin de ligne */
+            start = end;
+            continue;
+        }
+
+        if (semi && frame_len <= CAT_WIRE_MAX) {
+            bool idle = ctx->pipe.backlog_head == ctx->pipe.backlog_tail;
+            uint64_t hits = ctx->cache.hits;
+            int rc = cat_is_read_request(frame, frame_len) ?
+                cat_pipeline_submit_frame(&ctx->pipe, frame, frame_len, on_answer, ctx) :
+                cat_pipeline_submit_set(&ctx->pipe, frame, frame_len, on_set_answer, ctx);
+            if (rc < 0)
+                return -1;
+            cat_pipeline_pump(&ctx->pipe);
+
+            /* Seule en file, elle est partie, ou le cache y a répondu (déjà affiché) */
+            if (!idle || ctx->pipe.backlog_head != ctx->pipe.backlog_tail)
+                (*waiting)++;
+            else if (ctx->cache.hits == hits)
+                *sent += frame_len;
+        } else if (port_engine_send(&s->engine, port, frame, frame_len) < 0) {
+            return -1;
+        } else {
+            cat_cache_invalidate(&ctx->cache, frame, frame_len);
+            cat_pipeline_note_set(&ctx->pipe, on_set_answer, ctx);
+            *sent += frame_len;
+        }
+        start = end;
+    }
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Une ligne complète (avec son '\n') : routage « @N » puis envoi */
+static void send_line(session_t *s, char *line, size_t len)
+{
+    int id = s->target;
+
+    if (line[0] == '@') {
+        char *end = NULL;
+        long v = strtol(line + 1, &end, 10);
+        if (end == line + 1 || v < 0 || !port_engine_port(&s->engine, (int)v)) {
+            fprintf(stderr, "⚠️  Port inconnu : %.*s", (int)len, line);
+            return;
+        }
+        id = (int)v;
+        while (*end == ' ') end++;
+        len -= (size_t)(end - line);
+        line = end;
+
+        if (len == 0 || line[0] == '\n') {
+            s->target = id;
+            printf("[=] Lignes suivantes → %s\n", port_engine_port(&s->engine, id)->name);
+            return;
+        }
+    }
+
+    engine_port_t *port = port_engine_port(&s->engine, id);
+    if (!port) {
+        fprintf(stderr, "⚠️  Le port %d est fermé.\n", id);
+        return;
+    }
+    size_t sent = 0, waiting = 0;
+    int rc = send_segments(s, port, line, len, &sent, &waiting);
+    if (sent)
+        printf("[→] %zu octet(s) envoyé(s) vers %s.\n", sent, port->name);
+    if (waiting)
+        printf("[…] %zu trame(s) en attente de place dans la fenêtre de %s.\n", waiting, port->name);
+    if (rc < 0)
+        fprintf(stderr, "⚠️  Envoi impossible vers %s : %s\n", port->name,
+                errno ? strerror(errno) : "file pleine");
+}
+
+/* stdin est lu en brut : fgets() bufferiserait des lignes qu’epoll ne verrait plus */
+static void on_stdin(int fd, uint32_t events, void *user_data)
+{
+    (void)events;
+    session_t *s = user_data;
+
+    ssize_t r = read(fd, s->line + s->line_len, sizeof(s->line) - s->line_len);
+    if (r < 0) {
+        if (errno == EINTR || errno == EAGAIN) return;
+        perror("read");
+        s->quit = true;
+        return;
+    }
+    if (r == 0) {   /* EOF (Ctrl‑D) */
+        printf("\n🔚  Fin de l’entrée utilisateur – fermeture des ports.\n");
+        s->quit = true;
+        return;
+    }
+    s->line_len += (size_t)r;
+
+    size_t start = 0;
+    for (size_t i = s->line_len - (size_t)r; i < s->line_len; ++i) {
+        if (s->line[i] != '\n') continue;
+        errno = 0;
+        send_line(s, s->line + start, i + 1 - start);
+        start = i + 1;
+    }
+
+    /* Ligne trop longue : envoyée telle quelle */
+    if (start == 0 && s->line_len == sizeof(s->line)) {
+        errno = 0;
+        send_line(s, s->line, s->line_len);
+        start = s->line_len;
+    }
+    memmove(s->line, s->line + start, s->line_len - start);
+    s->line_len -= start;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Mode lot (-f). Tout le fichier est lu avant la boucle, donc getline() ne
+ * cache rien à epoll ici. Une ligne peut porter plusieurs trames ; chacune
+ * donne un résultat sur stdout : commande, réponse, latence en ms, séparés
+ * par des tabulations. */
+
+static int batch_add(batch_t *b, const char *frame, size_t len, int port)
+{
+    bool semi = frame[len - 1] == ';';
+
+    if (b->text_len + len + 1 > b->text_cap) {
+        size_t cap = b->text_cap ? b->text_cap * 2 : 4096;
+        while (cap < b->text_len + len + 1)
+            cap *= 2;
+        char *text = realloc(b->text, cap);
+        if (!text)
+            return -1;
+        b->text = text;
+        b->text_cap = cap;
+    }
+    if (b->count == b->cap) {
+        size_t cap = b->cap ? b->cap * 2 : 256;
+        batch_cmd_t *cmds = realloc(b->cmds, cap * sizeof(*cmds));
+        if (!cmds)
+            return -1;
+        b->cmds = cmds;
+        b->cap = cap;
+    }
+
+    batch_cmd_t *c = &b->cmds[b->count++];
+    memset(c, 0, sizeof(*c));
+    c->text = b->text_len;
+    c->port = port;
+    memcpy(b->text + b->text_len, frame, len);
+    b->text_len += len;
+    if (!semi)
+        b->text[b->text_len++] = ';';   /* « FA » seul vaut « FA; » */
+    c->len = b->text_len - c->text;
+    c->read = c->len <= CAT_WIRE_MAX && cat_is_read_request(b->text + c->text, c->len);
+    return 0;
+}
+
+/* Lignes vides et commentaires « # » ignorés ; « @N » route comme en interactif */
+static int batch_load(batch_t *b, const char *path, size_t port_count)
+{
+    bool from_stdin = strcmp(path, "-") == 0;
+    FILE *f = from_stdin ? stdin : fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t n;
+    unsigned lineno = 0;
+    int target = 0;
+    int rc = 0;
+
+    while (rc == 0 && (n = getline(&line, &size, f)) >= 0) {
+        lineno++;
+        while (n > 0 && strchr("\r\n \t", line[n - 1]))
+            line[--n] = '\0';
+        char *p = line;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p == '\0' || *p == '#')
+            continue;
+
+        int port = target;
+        if (*p == '@') {
+            char *end = NULL;
+            long v = strtol(p + 1, &end, 10);
+            if (end == p + 1 || v < 0 || (size_t)v >= port_count) {
+                fprintf(stderr, "❌  %s:%u : port inconnu : %s\n", from_stdin ? "stdin" : path, lineno, p);
+                rc = -1;
+                break;
+            }
+            port = (int)v;
+            p = end;
+            while (*p == ' ' || *p == '\t')
+                p++;
+            if (*p == '\0') {
+                target = port;
+                continue;
+            }
+        }
+
+        while (rc == 0 && *p) {
+            char *semi = strchr(p, ';');
+            size_t len = semi ? (size_t)(semi - p) + 1 : strlen(p);
+            if (len > 0 && !(len == 1 && semi))   /* « ;; » : rien à envoyer */
+                rc = batch_add(b, p, len, port);
+            p += len;
+            while (*p == ' ' || *p == '\t')
+                p++;
+        }
+        if (rc < 0)
+            perror("realloc");
+    }
+    if (rc == 0 && ferror(f)) {
+        perror(path);
+        rc = -1;
+    }
+    free(line);
+    if (!from_stdin)
+        fclose(f);
+    return rc;
+}
+
+static void batch_free(batch_t *b)
+{
+    free(b->text);
+    free(b->cmds);
+    memset(b, 0, sizeof(*b));
+}
+
+static void on_batch_answer(cat_request_status_t status, const cat_response_t *resp,
+                            const char *frame, size_t len, uint64_t rtt_ns, void *user_data)
+{
+    (void)resp;
+    batch_cmd_t *c = user_data;
+
+    c->status = status;
+    c->rtt_ns = rtt_ns;
+    if (frame && len <= sizeof(c->answer)) {
+        memcpy(c->answer, frame, len);
+        c->answer_len = len;
+    }
+    c->done = true;
+}
+
+/* Écrit les résultats dans l’ordre du fichier : une réponse rapide attend
+ * celles des commandes qui la précèdent */
+static void batch_print(batch_t *b)
+{
+    while (b->printed < b->count && b->cmds[b->printed].done) {
+        const batch_cmd_t *c = &b->cmds[b->printed++];
+
+        printf("%.*s\t", (int)c->len, b->text + c->text);
+        switch (c->status) {
+            case CAT_REQUEST_OK:
+                if (c->read)
+                    printf("%.*s\t%.3f\n", (int)c->answer_len, c->answer, c->rtt_ns / 1e6);
+                else
+                    printf("-\t-\n");   /* réglage accepté : la radio ne répond rien */
+                break;
+            case CAT_REQUEST_REJECTED:   /* « ?; » : lecture ou réglage refusé */
+                printf("%.*s\t%.3f\n", (int)c->answer_len, c->answer, c->rtt_ns / 1e6);
+                b->failed++;
+                break;
+            case CAT_REQUEST_TIMEOUT:
+                printf("TIMEOUT\t%.3f\n", c->rtt_ns / 1e6);
+                b->failed++;
+                break;
+            case CAT_REQUEST_CANCELLED:
+                printf("CANCELLED\t-\n");
+                b->failed++;
+                break;
+        }
+    }
+}
+
+/* Envoie tout ce que les fenêtres et les files acceptent, puis écrit les
+ * résultats prêts ; appelé après chaque tour de boucle */
+static void batch_progress(session_t *s)
+{
+    batch_t *b = s->batch;
+
+    while (b->next < b->count) {
+        batch_cmd_t *c = &b->cmds[b->next];
+        port_ctx_t *ctx = &s->ports[c->port];
+        const char *frame = b->text + c->text;
+
+        if (!ctx->port) {
+            c->status = CAT_REQUEST_CANCELLED;
+            c->done = true;
+        } else if (c->len <= CAT_WIRE_MAX) {
+            /* Un réglage attend dans la file derrière les lectures qui le
+             * précèdent ; il est terminé quand la radio l’a refusé (« ?; »)
+             * ou visiblement dépassé sans rien dire */
+            int rc = c->read ?
+                cat_pipeline_submit_frame(&ctx->pipe, frame, c->len, on_batch_answer, c) :
+                cat_pipeline_submit_set(&ctx->pipe, frame, c->len, on_batch_answer, c);
+            if (rc < 0)
+                break;   /* file d’attente pleine : une réponse la videra */
+            cat_pipeline_pump(&ctx->pipe);
+        } else {
+            /* Trop longue pour la file : part seule, une fois la file vide */
+            if (cat_pipeline_pending(&ctx->pipe) > 0 ||
+                port_engine_send(&s->engine, ctx->port, frame, c->len) < 0)
+                break;
+            cat_cache_invalidate(&ctx->cache, frame, c->len);
+            cat_pipeline_note_set(&ctx->pipe, on_batch_answer, c);
+        }
+        b->next++;
+    }
+
+    batch_print(b);
+    fflush(stdout);
+    if (b->printed == b->count)
+        s->quit = true;
+}
+
+/* Sortie anticipée (port fermé, signal) : le reste est écrit comme annulé */
+static void batch_finish(session_t *s)
+{
+    batch_t *b = s->batch;
+
+    for (size_t i = 0; i < MAX_PORTS; ++i)
+        cat_pipeline_cancel(&s->ports[i].pipe);
+    for (size_t i = b->next; i < b->count; ++i) {
+        b->cmds[i].status = CAT_REQUEST_CANCELLED;
+        b->cmds[i].done = true;
+    }
+    batch_print(b);
+    fflush(stdout);
+}
+
+/* Le moteur ferme les descripteurs, puis chaque transport libère le reste */
+static void close_session(session_t *s, size_t transport_count)
+{
+    port_engine_free(&s->engine);
+    for (size_t i = 0; i < transport_count; ++i)
+        transport_close(&s->transports[i]);
+    cat_capture_close(&s->capture);
+    radio_shm_close(&s->shm);
+    if (s->listen_fd >= 0)
+        close(s->listen_fd);
+    if (s->unix_path[0])
+        unlink(s->unix_path);
 }
 
 /* -------------------------------------------------------------------------- */
 int main(int argc, char *argv[])
 {
-    const char *device = DEFAULT_DEVICE;
+    const char *devices[MAX_PORTS];
+    size_t device_count = 0;
     int baud = DEFAULT_BAUD;
+    const char *capture_path = NULL;
+    const char *listen_spec = NULL;
+    const char *shm_name = NULL;
+    const char *batch_path = NULL;
+    bool use_cache = true;
+
+    info = stdout;
 
     /* ---------- Traitement des options ---------- */
     int opt;
-    while ((opt = getopt(argc, argv, "d:b:lh")) != -1) {
+    while ((opt = getopt(argc, argv, "d:b:w:Cm:s:f:lh")) != -1) {
         switch (opt) {
             case 'd':
-                device = optarg;
+                if (device_count == MAX_PORTS) {
+                    fprintf(stderr, "⚠️  Trop de ports (max %d), %s ignoré.\n",
+                            MAX_PORTS, optarg);
+                } else {
+                    devices[device_count++] = optarg;
+                }
                 break;
             case 'b': {
                 char *endptr = NULL;
@@ -171,6 +1066,21 @@ int main(int argc, char *argv[])
                 }
                 break;
             }
+            case 'w':
+                capture_path = optarg;
+                break;
+            case 'C':
+                use_cache = false;
+                break;
+            case 'm':
+                shm_name = optarg;
+                break;
+            case 's':
+                listen_spec = optarg;
+                break;
+            case 'f':
+                batch_path = optarg;
+                break;
             case 'l':
                 print_supported_bauds();
                 return EXIT_SUCCESS;
@@ -182,74 +1092,154 @@ int main(int argc, char *argv[])
                 return EXIT_FAILURE;
         }
     }
+    if (device_count == 0)
+        devices[device_count++] = DEFAULT_DEVICE;
+    if (batch_path && listen_spec) {
+        fprintf(stderr, "❌  -f et -s s’excluent : l’un lit un fichier, l’autre des clients.\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Lu en entier avant d’ouvrir quoi que ce soit : une erreur n’envoie rien */
+    static batch_t batch;
+    if (batch_path) {
+        info = stderr;
+        if (batch_load(&batch, batch_path, device_count) < 0) {
+            batch_free(&batch);
+            return EXIT_FAILURE;
+        }
+    }
 
-    /* ---------- Ouverture et configuration du port ---------- */
-    int fd = init_serial(device, baud);
-    if (fd < 0) {
-        fprintf(stderr, "❌  Impossible d’ouvrir le port %s\n", device);
+    static session_t session;
+    session.capture.fd = -1;
+    session.listen_fd = -1;
+    if (port_engine_init(&session.engine, on_port_frames, on_port_closed, &session) < 0) {
+        perror("epoll_create1");
         return EXIT_FAILURE;
     }
 
-    printf("✅  Port %s ouvert à %d baud.\n", device, baud);
-    printf("Tapez du texte, appuyez sur <Entrée> → envoi.\n");
-    printf("Les réponses du périphérique seront affichées immédiatement.\n");
-    printf("Ctrl‑D (EOF) pour quitter.\n\n");
+    /* Avant les ports : le premier octet échangé est déjà enregistré */
+    if (capture_path) {
+        if (cat_capture_open(&session.capture, capture_path) < 0) {
+            fprintf(stderr, "❌  Enregistrement impossible dans %s : %s\n", capture_path,
+                    errno == EINVAL ? "ce n’est pas une capture" : strerror(errno));
+            close_session(&session, 0);
+            return EXIT_FAILURE;
+        }
+        port_engine_set_capture(&session.engine, &session.capture);
+        fprintf(info, "⏺  Trafic enregistré dans %s.\n", capture_path);
+    }
 
-    /* ---------- Boucle full‑duplex (stdin ↔ port série) ---------- */
-    char line[MAX_LINE];
-    while (1) {
-        fd_set read_fds;
-        FD_ZERO(&read_fds);
-        FD_SET(STDIN_FILENO, &read_fds);
-        FD_SET(fd, &read_fds);
+    if (shm_name) {
+        if (radio_shm_create(&session.shm, shm_name) < 0) {
+            fprintf(stderr, "❌  Publication impossible sous %s : %s\n", shm_name,
+                    errno == EINVAL ? "le nom doit être de la forme /nom" : strerror(errno));
+            close_session(&session, 0);
+            return EXIT_FAILURE;
+        }
+        radio_state_reset(&session.state);
+        fprintf(info, "📡  État de la radio publié sous %s.\n", shm_name);
+    }
 
-        int maxfd = (STDIN_FILENO > fd) ? STDIN_FILENO : fd;
-        int sel = select(maxfd + 1, &read_fds, NULL, NULL, NULL);
-        if (sel < 0) {
-            perror("select");
-            break;
+    /* ---------- Ouverture et configuration des ports ---------- */
+    for (size_t i = 0; i < device_count; ++i) {
+        transport_t *t = &session.transports[i];
+        if (open_transport(t, devices[i], baud) < 0 ||
+            !port_engine_add_port(&session.engine, t->fd, devices[i])) {
+            fprintf(stderr, "❌  Impossible d’ouvrir le port %s\n", devices[i]);
+            close_session(&session, i + 1);
+            return EXIT_FAILURE;
         }
+        transport_release_fd(t);      /* le moteur le fermera */
+        port_ctx_t *ctx = &session.ports[i];
+        ctx->port = port_engine_port(&session.engine, (int)i);
+        ctx->port->user_data = ctx;
+        ctx->engine = &session.engine;
+        session.radio_count++;
+        cat_pipeline_init(&ctx->pipe, CAT_PIPELINE_MAX_DEPTH, pipe_write, ctx);
+        cat_cache_init(&ctx->cache);
+        if (use_cache)
+            cat_pipeline_set_cache(&ctx->pipe, &ctx->cache);
+        fprintf(info, "✅  Port %zu : %s ouvert à %d baud.\n", i, devices[i], baud);
+    }
 
-        /* ----- Données provenant du clavier (stdin) ----- */
-        if (FD_ISSET(STDIN_FILENO, &read_fds)) {
-            if (fgets(line, sizeof(line), stdin) == NULL) {   /* EOF (Ctrl‑D) */
-                printf("\n🔚  Fin de l’entrée utilisateur – fermeture du port.\n");
-                break;
-            }
+    session.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (session.timer_fd < 0 ||
+        port_engine_add_fd(&session.engine, session.timer_fd, on_timer, &session) < 0) {
+        perror("timerfd");
+        close_session(&session, device_count);
+        return EXIT_FAILURE;
+    }
 
-            size_t len = strlen(line);
-            if (len == 0) continue;   /* rien à envoyer */
+    if (listen_spec) {
+        /* Un client qui ferme pendant un envoi ne doit pas tuer le serveur */
+        struct sigaction sa = { .sa_handler = on_stop_signal };
+        sigaction(SIGINT, &sa, NULL);
+        sigaction(SIGTERM, &sa, NULL);
+        signal(SIGPIPE, SIG_IGN);
 
-            ssize_t w = write(fd, line, len);
-            if (w < 0) {
-                perror("write");
-                break;
-            }
-            printf("[→] %zd octet(s) envoyé(s).\n", w);
+        if (open_listener(&session, listen_spec) < 0 ||
+            port_engine_add_fd(&session.engine, session.listen_fd, on_accept, &session) < 0) {
+            fprintf(stderr, "❌  Écoute impossible sur %s : %s\n", listen_spec, strerror(errno));
+            close_session(&session, device_count);
+            return EXIT_FAILURE;
         }
+        printf("🔌  En écoute sur %s ; SIGINT ou SIGTERM pour arrêter.\n", listen_spec);
+    } else if (batch_path) {
+        /* Interrompu : les commandes restantes sont tout de même écrites, annulées */
+        struct sigaction sa = { .sa_handler = on_stop_signal };
+        sigaction(SIGINT, &sa, NULL);
+        sigaction(SIGTERM, &sa, NULL);
 
-        /* ----- Données provenant du port série ----- */
-        if (FD_ISSET(fd, &read_fds)) {
-            char resp[MAX_LINE];
-            ssize_t r = read(fd, resp, sizeof(resp) - 1);
-            if (r < 0) {
-                perror("read");
-                break;
-            } else if (r == 0) {
-                printf("[←] (lecture retournée 0 octet – périphérique fermé?)\n");
-                continue;
-            }
+        session.batch = &batch;
+        batch.start_ns = cat_monotonic_ns();
+        fprintf(info, "📜  %zu commande(s) lue(s) depuis %s.\n", batch.count,
+                strcmp(batch_path, "-") == 0 ? "stdin" : batch_path);
+        batch_progress(&session);
+        arm_timer(&session);
+    } else {
+        if (port_engine_add_fd(&session.engine, STDIN_FILENO, on_stdin, &session) < 0) {
+            perror("epoll_ctl(stdin)");
+            close_session(&session, device_count);
+            return EXIT_FAILURE;
+        }
 
-            resp[r] = '\0';
-            while (r > 0 && (resp[r-1] == '\n' || resp[r-1] == '\r')) {
-                resp[--r] = '\0';
-            }
+        printf("Tapez du texte, appuyez sur <Entrée> → envoi.\n");
+        printf("Les réponses du périphérique seront affichées immédiatement.\n");
+        printf("Ctrl‑D (EOF) pour quitter.\n\n");
+    }
+    fflush(stdout);
 
-            printf("[←] %zd octet(s) reçu(s) : %s\n", r, resp);
+    /* ---------- Boucle full‑duplex (stdin, fichier ou clients ↔ ports série) ---------- */
+    while (!session.quit && !stop_requested && session.radio_count > 0) {
+        if (port_engine_run_once(&session.engine, -1) < 0) {
+            perror("epoll_wait");
+            break;
         }
+        if (session.batch)
+            batch_progress(&session);
+        arm_timer(&session);
     }
 
-    close(fd);
-    printf("\n🔚  Port fermé. Au revoir.\n");
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+    int status = EXIT_SUCCESS;
+    if (session.batch) {
+        batch_finish(&session);
+        fprintf(info, "\n📊  %zu commande(s) en %.1f ms, %zu en échec.", batch.count,
+                (cat_monotonic_ns() - batch.start_ns) / 1e6, batch.failed);
+        if (batch.failed)
+            status = EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < device_count; ++i) {
+        if (session.ports[i].cache.hits)
+            fprintf(info, "\n💾  %s : %llu lecture(s) servie(s) par le cache.", devices[i],
+                    (unsigned long long)session.ports[i].cache.hits);
+    }
+    if (listen_spec)
+        printf("\n📊  %llu lecture(s) de clients, dont %llu servie(s) par une lecture déjà en vol.\n",
+               (unsigned long long)session.client_reads, (unsigned long long)session.merged_reads);
+    close_session(&session, device_count);
+    close(session.timer_fd);
+    batch_free(&batch);
+    fprintf(info, "\n🔚  Ports fermés. Au revoir.\n");
+    return status;
+}
@@ -0,0 +1,598 @@
+/*
+ * ftx1_sim.c - FTX-1 stand-in on a pseudo-terminal
+ *
+ * Opens a pty (or any other transport spec) and answers the CAT commands
+ * of radios/ftx1_cat.h from a live radio state: FA/FB, MD, AG, RG, SQ,
+ * PC, GT, ST, CN, AI, VE, RI, TX, band up/down/select and VFO copies.
+ * Sets change the state and stay silent, like the radio; with AI1 every
+ * change is reported as an unsolicited answer.
+ *
+ * Timing follows the radio rather than the pty: commands are taken at
+ * the configured baud rate, handled one at a time with a per-command
+ * processing latency, and answers leave at baud/10 bytes per second.
+ * A "fast tuning" storm steps VFO-A at a fixed rate, as if the dial were
+ * spun; queued AI updates of the same value are coalesced, as the radio
+ * only ever reports its latest state.
+ *
+ * Build and run:  make sim && sim/ftx1_sim
+ * Then connect:   ./serial-send -d /tmp/ftx1   (radio-ui, serial-send-ui alike)
+ * Options:        -d <spec> -b <baud> -l <latency us> -L <XX=us> -a
+ *                 -s <storm Hz> -t <storm step Hz> -v
+ */
+
+#define _GNU_SOURCE     /* ppoll */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include "radios/ftx1_cat.h"
+#include "radios/cat_framer.h"
+#include "serial/transport.h"
+
+#define SIM_QUEUE       256     /* Frames waiting for the line */
+#define SIM_FIRMWARE    "0105"
+#define SIM_MODEL       "FTX-1"
+#define STORM_SWING     500     /* Storm steps before the dial turns back */
+
+#define OPCODE_INDEX(a, b) ((((a) - 'A') * 26) + ((b) - 'A'))
+
+static int baudrate = 38400;
+static uint64_t default_latency_ns = 2000000;
+static uint64_t latency_ns[26 * 26];        /* 0: use the default */
+static uint64_t storm_period_ns;            /* 0: no storm */
+static uint32_t storm_step = 10;
+static int verbose;
+static volatile sig_atomic_t stop;
+
+/* -------------------------------------------------------------------------- */
+/* Radio state */
+
+typedef struct {
+    uint32_t frequency[2];
+    operating_mode_t mode[2];
+    uint8_t af_gain[2];
+    uint8_t rf_gain[2];
+    uint8_t squelch[2];
+    agc_type_t agc[2];
+    uint8_t tone_type[2];
+    uint8_t tone_code[2];
+    uint8_t power;
+    bool split;
+    bool auto_info;
+    bool transmit;
+} sim_state_t;
+
+/* Edges and the frequency BS/BU/BD land on, indexed by band_select_t */
+static const struct {
+    uint32_t low, high, home;
+} bands[] = {
+    [BAND_1_8MHZ]    = {   1800000,   2000000,   1840000 },
+    [BAND_3_5MHZ]    = {   3500000,   4000000,   3573000 },
+    [BAND_5MHZ]      = {   5250000,   5450000,   5357000 },
+    [BAND_7MHZ]      = {   7000000,   7300000,   7074000 },
+    [BAND_10MHZ]     = {  10100000,  10150000,  10136000 },
+    [BAND_14MHZ]     = {  14000000,  14350000,  14074000 },
+    [BAND_18MHZ]     = {  18068000,  18168000,  18100000 },
+    [BAND_21MHZ]     = {  21000000,  21450000,  21074000 },
+    [BAND_24_5MHZ]   = {  24890000,  24990000,  24915000 },
+    [BAND_28MHZ]     = {  28000000,  29700000,  28074000 },
+    [BAND_50MHZ]     = {  50000000,  54000000,  50313000 },
+    [BAND_70MHZ_GEN] = {  70000000,  70500000,  70154000 },
+    [BAND_AIR]       = { 108000000, 137000000, 118000000 },
+    [BAND_144MHZ]    = { 144000000, 148000000, 144174000 },
+    [BAND_430MHZ]    = { 430000000, 450000000, 432174000 },
+};
+#define BAND_COUNT (sizeof(bands)/sizeof(bands[0]))
+
+static void state_init(sim_state_t *st)
+{
+    memset(st, 0, sizeof(*st));
+    for (int v = 0; v < 2; ++v) {
+        st->mode[v] = MODE_USB;
+        st->af_gain[v] = 128;
+        st->rf_gain[v] = 255;
+        st->agc[v] = AGC_AUTO;
+        st->tone_code[v] = 12;
+    }
+    st->frequency[VFO_MAIN] = 14074000;
+    st->frequency[VFO_SUB] = 7074000;
+    st->mode[VFO_SUB] = MODE_LSB;
+    st->power = 100;
+}
+
+/* Band holding freq, or the highest band below it */
+static size_t band_of(uint32_t freq)
+{
+    size_t band = 0;
+    for (size_t i = 0; i < BAND_COUNT; ++i)
+        if (freq >= bands[i].low)
+            band = i;
+    return band;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Simulated radio */
+
+typedef struct {
+    char text[CAT_FRAMER_MAX_FRAME];
+    size_t len;
+    uint64_t deliver_ns;        /* Last byte leaves the radio */
+    bool update;                /* AI report, may be replaced by a newer one */
+} sim_frame_t;
+
+typedef struct {
+    transport_t port;
+    sim_state_t state;
+    cat_framer_t framer;
+    sim_frame_t queue[SIM_QUEUE];
+    size_t head, tail;
+    uint64_t byte_ns;           /* Wire time of one byte, 8N1 */
+    uint64_t rx_free_ns;        /* Last command byte received */
+    uint64_t busy_ns;           /* Radio done with the command it is handling */
+    uint64_t tx_free_ns;        /* Line free after the last queued frame */
+    uint64_t storm_next_ns;
+    int storm_dir;
+    unsigned storm_count;
+    /* Counters for the exit report */
+    uint64_t commands, answers, updates, coalesced, rejected, dropped;
+} sim_radio_t;
+
+static uint64_t command_latency(const char *frame)
+{
+    if (frame[0] >= 'A' && frame[0] <= 'Z' && frame[1] >= 'A' && frame[1] <= 'Z') {
+        uint64_t ns = latency_ns[OPCODE_INDEX(frame[0], frame[1])];
+        if (ns)
+            return ns;
+    }
+    return default_latency_ns;
+}
+
+static void queue_frame(sim_radio_t *sim, const char *text, size_t len, uint64_t ready_ns, bool update)
+{
+    /* The previous report of the same value has not left yet: send the new one instead */
+    if (update && sim->head != sim->tail) {
+        sim_frame_t *last = &sim->queue[(sim->head - 1) % SIM_QUEUE];
+        if (last->update && last->len == len &&
+            cat_request_key(last->text, last->len) == cat_request_key(text, len)) {
+            memcpy(last->text, text, len);
+            sim->coalesced++;
+            return;
+        }
+    }
+    if (sim->head - sim->tail == SIM_QUEUE) {
+        sim->dropped++;
+        return;
+    }
+
+    sim_frame_t *f = &sim->queue[sim->head++ % SIM_QUEUE];
+    memcpy(f->text, text, len);
+    f->len = len;
+    f->update = update;
+
+    uint64_t start = ready_ns > sim->tx_free_ns ? ready_ns : sim->tx_free_ns;
+    f->deliver_ns = start + len * sim->byte_ns;
+    sim->tx_free_ns = f->deliver_ns;
+
+    if (update)
+        sim->updates++;
+    else
+        sim->answers++;
+}
+
+static int encode(const cat_command_t *cmd, char *out)
+{
+    return cat_encode_command(cmd, out, CAT_WIRE_MAX);
+}
+
+/* Answer to a read of opcode op (VFO digit in vfo_char), from the current state */
+static int build_answer(const sim_state_t *st, uint16_t op, char vfo_char, char *out)
+{
+    vfo_select_t vfo = vfo_char == '1' ? VFO_SUB : VFO_MAIN;
+    cat_command_t cmd;
+
+    switch (op) {
+        case CAT_OPCODE('F', 'A'):
+            cat_build_frequency_set(&cmd, VFO_MAIN, st->frequency[VFO_MAIN]);
+            break;
+        case CAT_OPCODE('F', 'B'):
+            cat_build_frequency_set(&cmd, VFO_SUB, st->frequency[VFO_SUB]);
+            break;
+        case CAT_OPCODE('M', 'D'):
+            cat_build_mode_set(&cmd, vfo, st->mode[vfo]);
+            break;
+        case CAT_OPCODE('A', 'G'):
+            cat_build_af_gain_set(&cmd, vfo, st->af_gain[vfo]);
+            break;
+        case CAT_OPCODE('R', 'G'):
+            cat_build_rf_gain_set(&cmd, vfo, st->rf_gain[vfo]);
+            break;
+        case CAT_OPCODE('S', 'Q'):
+            cat_build_squelch_set(&cmd, vfo, st->squelch[vfo]);
+            break;
+        case CAT_OPCODE('P', 'C'):
+            cat_build_power_set(&cmd, st->power);
+            break;
+        case CAT_OPCODE('G', 'T'):
+            cat_build_agc_set(&cmd, vfo, st->agc[vfo]);
+            break;
+        case CAT_OPCODE('S', 'T'):
+            cat_build_split_set(&cmd, st->split);
+            break;
+        case CAT_OPCODE('C', 'N'):
+            cat_build_ctcss_set(&cmd, vfo, st->tone_type[vfo], st->tone_code[vfo]);
+            break;
+        case CAT_OPCODE('A', 'I'):
+            cat_build_auto_info_set(&cmd, st->auto_info);
+            break;
+        case CAT_OPCODE('T', 'X'):
+            cat_build_ptt_set(&cmd, st->transmit);
+            break;
+        case CAT_OPCODE('V', 'E'):
+            return sprintf(out, "VE%s;", SIM_FIRMWARE);
+        case CAT_OPCODE('R', 'I'):
+            return sprintf(out, "RI%s;", SIM_MODEL);
+        default:
+            return -1;
+    }
+    return encode(&cmd, out);
+}
+
+/* With AI1, report a changed value the way a read would return it */
+static void report(sim_radio_t *sim, uint16_t op, char vfo_char, uint64_t ready_ns)
+{
+    char text[CAT_WIRE_MAX];
+
+    if (!sim->state.auto_info)
+        return;
+    int n = build_answer(&sim->state, op, vfo_char, text);
+    if (n > 0)
+        queue_frame(sim, text, (size_t)n, ready_ns, true);
+}
+
+static void report_frequencies(sim_radio_t *sim, uint64_t ready_ns)
+{
+    report(sim, CAT_OPCODE('F', 'A'), '0', ready_ns);
+    report(sim, CAT_OPCODE('F', 'B'), '0', ready_ns);
+}
+
+/* Apply a set that shares its layout with the answer. -1 if out of range. */
+static int apply_set(sim_state_t *st, const cat_response_t *r)
+{
+    switch (r->type) {
+        case CAT_RESP_FREQUENCY:
+            if (r->data.frequency.frequency < 30000 || r->data.frequency.frequency > 470000000)
+                return -1;
+            st->frequency[r->data.frequency.vfo] = r->data.frequency.frequency;
+            return 0;
+        case CAT_RESP_MODE:
+            st->mode[r->data.mode.vfo] = r->data.mode.mode;
+            return 0;
+        case CAT_RESP_AF_GAIN:
+            st->af_gain[r->data.af_gain.vfo] = r->data.af_gain.level;
+            return 0;
+        case CAT_RESP_RF_GAIN:
+            st->rf_gain[r->data.rf_gain.vfo] = r->data.rf_gain.level;
+            return 0;
+        case CAT_RESP_SQUELCH:
+            st->squelch[r->data.squelch.vfo] = r->data.squelch.level;
+            return 0;
+        case CAT_RESP_POWER:
+            st->power = r->data.power.watts;
+            return 0;
+        case CAT_RESP_AGC:
+            if (r->data.agc.agc > AGC_OFF)
+                return -1;
+            st->agc[r->data.agc.vfo] = r->data.agc.agc;
+            return 0;
+        case CAT_RESP_SPLIT:
+            st->split = r->data.split.enabled;
+            return 0;
+        case CAT_RESP_CTCSS:
+            st->tone_type[r->data.ctcss.vfo] = r->data.ctcss.type;
+            st->tone_code[r->data.ctcss.vfo] = r->data.ctcss.code;
+            return 0;
+        case CAT_RESP_AUTO_INFO:
+            st->auto_info = r->data.auto_info.enabled;
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+/* Commands without an answer layout of their own. 0 if handled, -1 to reject. */
+static int handle_action(sim_radio_t *sim, const char *frame, size_t len, uint64_t done_ns)
+{
+    sim_state_t *st = &sim->state;
+    vfo_select_t vfo = (len > 3 && frame[2] == '1') ? VFO_SUB : VFO_MAIN;
+    size_t band;
+
+    switch (CAT_OPCODE(frame[0], frame[1])) {
+        case CAT_OPCODE('B', 'U'):
+        case CAT_OPCODE('B', 'D'):
+            if (len != 4)
+                return -1;
+            band = band_of(st->frequency[vfo]);
+            band = frame[1] == 'U' ? (band + 1) % BAND_COUNT : (band + BAND_COUNT - 1) % BAND_COUNT;
+            st->frequency[vfo] = bands[band].home;
+            report_frequencies(sim, done_ns);
+            return 0;
+        case CAT_OPCODE('B', 'S'): {
+            uint32_t sel;
+            if (len != 6 || cat_decode_digits(frame + 3, 2, &sel) != 0 || sel >= BAND_COUNT)
+                return -1;
+            st->frequency[vfo] = bands[sel].home;
+            report_frequencies(sim, done_ns);
+            return 0;
+        }
+        case CAT_OPCODE('A', 'B'):
+        case CAT_OPCODE('B', 'A'): {
+            if (len != 3)
+                return -1;
+            vfo_select_t from = frame[0] == 'A' ? VFO_MAIN : VFO_SUB;
+            vfo_select_t to = from == VFO_MAIN ? VFO_SUB : VFO_MAIN;
+            st->frequency[to] = st->frequency[from];
+            st->mode[to] = st->mode[from];
+            report_frequencies(sim, done_ns);
+            report(sim, CAT_OPCODE('M', 'D'), to == VFO_SUB ? '1' : '0', done_ns);
+            return 0;
+        }
+        case CAT_OPCODE('T', 'X'):
+            if (len != 4 || (frame[2] != '0' && frame[2] != '1'))
+                return -1;
+            st->transmit = frame[2] == '1';
+            report(sim, CAT_OPCODE('T', 'X'), '0', done_ns);
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+static void handle_command(sim_radio_t *sim, const char *frame, size_t len, uint64_t rx_ns)
+{
+    /* In order: the command is in once its bytes are, handled once the radio is free */
+    uint64_t arrived = (rx_ns > sim->rx_free_ns ? rx_ns : sim->rx_free_ns) + len * sim->byte_ns;
+    uint64_t start = arrived > sim->busy_ns ? arrived : sim->busy_ns;
+    uint64_t done = start + command_latency(frame);
+    sim->rx_free_ns = arrived;
+    sim->busy_ns = done;
+    sim->commands++;
+
+    if (verbose)
+        printf("-> %.*s\n", (int)len, frame);
+
+    char text[CAT_WIRE_MAX];
+    int n = -1;
+
+    if (cat_is_read_request(frame, len) ||
+        (len == 3 && (CAT_OPCODE(frame[0], frame[1]) == CAT_OPCODE('T', 'X')))) {
+        n = build_answer(&sim->state, CAT_OPCODE(frame[0], frame[1]), len > 3 ? frame[2] : '0', text);
+    } else {
+        cat_response_t set;
+        if (cat_dispatch_response(frame, len, &set) == 0 &&
+            set.type != CAT_RESP_FIRMWARE && set.type != CAT_RESP_RADIO_INFO) {
+            if (apply_set(&sim->state, &set) == 0) {
+                if (set.type != CAT_RESP_AUTO_INFO)
+                    report(sim, set.opcode, frame[2], done);
+                return;
+            }
+        } else if (handle_action(sim, frame, len, done) == 0) {
+            return;
+        }
+    }
+
+    if (n < 0) {
+        memcpy(text, "?;", 2);
+        n = 2;
+        sim->rejected++;
+    }
+    queue_frame(sim, text, (size_t)n, done, false);
+}
+
+static void on_sim_frames(const cat_frame_t *frames, size_t count, void *user_data)
+{
+    sim_radio_t *sim = user_data;
+
+    for (size_t i = 0; i < count; ++i)
+        if (frames[i].len >= 3)
+            handle_command(sim, frames[i].data, frames[i].len, frames[i].rx_ns);
+}
+
+/* One turn of the dial; the storm sweeps up and down around its start */
+static void storm_step_once(sim_radio_t *sim, uint64_t now)
+{
+    uint32_t *freq = &sim->state.frequency[VFO_MAIN];
+
+    if (++sim->storm_count % STORM_SWING == 0)
+        sim->storm_dir = -sim->storm_dir;
+    if (sim->storm_dir < 0 && *freq <= storm_step)
+        sim->storm_dir = 1;
+    *freq = sim->storm_dir > 0 ? *freq + storm_step : *freq - storm_step;
+    report(sim, CAT_OPCODE('F', 'A'), '0', now);
+}
+
+/* Write every frame whose last byte is due. -1 if the port failed. */
+static int flush_due(sim_radio_t *sim, uint64_t now)
+{
+    while (sim->head != sim->tail) {
+        sim_frame_t *f = &sim->queue[sim->tail % SIM_QUEUE];
+        if (f->deliver_ns > now)
+            break;
+
+        ssize_t n = write(sim->port.fd, f->text, f->len);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return 0;       /* Nobody reading the pty: wait for room */
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n != (ssize_t)f->len)
+            return -1;
+        if (verbose)
+            printf("<- %.*s%s\n", (int)f->len, f->text, f->update ? "  (AI)" : "");
+        sim->tail++;
+    }
+    return 0;
+}
+
+static int run(sim_radio_t *sim)
+{
+    while (!stop) {
+        uint64_t now = cat_monotonic_ns();
+
+        while (storm_period_ns && sim->storm_next_ns <= now) {
+            storm_step_once(sim, now);
+            sim->storm_next_ns += storm_period_ns;
+        }
+        if (flush_due(sim, now) < 0) {
+            perror("write");
+            return -1;
+        }
+
+        /* Sleep until the next frame is due, the next storm step, or a command */
+        uint64_t next = UINT64_MAX;
+        bool blocked = false;
+        if (sim->head != sim->tail) {
+            next = sim->queue[sim->tail % SIM_QUEUE].deliver_ns;
+            blocked = next <= now;
+        }
+        if (storm_period_ns && sim->storm_next_ns < next)
+            next = sim->storm_next_ns;
+
+        struct pollfd pfd = { .fd = sim->port.fd, .events = POLLIN | (blocked ? POLLOUT : 0) };
+        struct timespec ts, *timeout = NULL;
+        if (next != UINT64_MAX && !blocked) {
+            uint64_t wait = next > now ? next - now : 0;
+            ts.tv_sec = (time_t)(wait / 1000000000ull);
+            ts.tv_nsec = (long)(wait % 1000000000ull);
+            timeout = &ts;
+        }
+
+        int rc = ppoll(&pfd, 1, timeout, NULL);
+        if (rc < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("ppoll");
+            return -1;
+        }
+        if (rc > 0 && (pfd.revents & (POLLIN | POLLHUP | POLLERR))) {
+            ssize_t n = cat_framer_read_fd(&sim->framer, sim->port.fd, on_sim_frames, sim);
+            if (n < 0 || (n == 0 && (pfd.revents & (POLLHUP | POLLERR)))) {
+                fprintf(stderr, "Port closed\n");
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop = 1;
+}
+
+static void print_usage(const char *progname)
+{
+    printf("Usage: %s [-d spec] [-b baud] [-l latency_us] [-L XX=us]... [-a] [-s storm_hz] [-t step_hz] [-v]\n"
+           "  -d <spec>   Where to answer (default pty:/tmp/ftx1, see serial/transport.h)\n"
+           "  -b <baud>   Simulated line speed (default 38400)\n"
+           "  -l <us>     Processing time per command (default 2000)\n"
+           "  -L XX=<us>  Processing time for one opcode, e.g. -L FA=500 (repeatable)\n"
+           "  -a          Start with auto information (AI1) on\n"
+           "  -s <hz>     Fast tuning storm: VFO-A steps per second (default off)\n"
+           "  -t <hz>     Frequency step of the storm (default 10)\n"
+           "  -v          Print every command and answer\n",
+           progname);
+}
+
+static long parse_positive(const char *arg, const char *what)
+{
+    char *endptr = NULL;
+    long v = strtol(arg, &endptr, 10);
+    if (*endptr != '\0' || v < 0) {
+        fprintf(stderr, "Invalid %s \"%s\"\n", what, arg);
+        exit(EXIT_FAILURE);
+    }
+    return v;
+}
+
+static void parse_opcode_latency(const char *arg)
+{
+    if (strlen(arg) < 4 || arg[2] != '=' || arg[0] < 'A' || arg[0] > 'Z' || arg[1] < 'A' || arg[1] > 'Z') {
+        fprintf(stderr, "Invalid per-command latency \"%s\" (expected XX=us)\n", arg);
+        exit(EXIT_FAILURE);
+    }
+    long us = parse_positive(arg + 3, "latency");
+    latency_ns[OPCODE_INDEX(arg[0], arg[1])] = us ? (uint64_t)us * 1000 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *spec = "pty:/tmp/ftx1";
+    bool auto_info = false;
+    long storm_rate = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:b:l:L:as:t:vh")) != -1) {
+        switch (opt) {
+            case 'd': spec = optarg; break;
+            case 'b': baudrate = (int)parse_positive(optarg, "baud rate"); break;
+            case 'l': default_latency_ns = (uint64_t)parse_positive(optarg, "latency") * 1000; break;
+            case 'L': parse_opcode_latency(optarg); break;
+            case 'a': auto_info = true; break;
+            case 's': storm_rate = parse_positive(optarg, "storm rate"); break;
+            case 't': storm_step = (uint32_t)parse_positive(optarg, "storm step"); break;
+            case 'v': verbose = 1; break;
+            case 'h':
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (baudrate <= 0 || storm_step == 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    static sim_radio_t sim;
+    if (transport_open(&sim.port, spec, baudrate) < 0) {
+        perror(spec);
+        return EXIT_FAILURE;
+    }
+    state_init(&sim.state);
+    sim.state.auto_info = auto_info;
+    cat_framer_reset(&sim.framer);
+    sim.byte_ns = 10ull * 1000000000ull / (uint64_t)baudrate;
+    sim.storm_dir = 1;
+    if (storm_rate > 0) {
+        storm_period_ns = 1000000000ull / (uint64_t)storm_rate;
+        sim.storm_next_ns = cat_monotonic_ns() + storm_period_ns;
+    }
+
+    struct sigaction sa = { .sa_handler = on_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    char report_line[256];
+    transport_describe(&sim.port, report_line, sizeof(report_line));
+    printf("FTX-1 simulator on %s\n", report_line);
+    printf("%d baud, %.1f ms per command", baudrate, default_latency_ns / 1e6);
+    if (storm_rate > 0)
+        printf(", tuning storm %ld steps/s of %u Hz", storm_rate, storm_step);
+    printf("\nCtrl-C to stop.\n");
+    fflush(stdout);
+
+    int status = run(&sim) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    printf("\n%llu command(s), %llu answer(s), %llu AI update(s), %llu coalesced, %llu rejected, %llu dropped\n",
+           (unsigned long long)sim.commands, (unsigned long long)sim.answers,
+           (unsigned long long)sim.updates, (unsigned long long)sim.coalesced,
+           (unsigned long long)sim.rejected, (unsigned long long)sim.dropped);
+    transport_close(&sim.port);
+    return status;
+}